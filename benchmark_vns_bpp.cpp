@@ -0,0 +1,429 @@
+// Author: Feiyang Wang fy916
+// The quality against time benchmark of the VNS bin packing solver: the standard instance sets are generated with their
+// published parameters and solved at several time budgets, and the bins, the gap, the time to the best solution and
+// the peak memory of each run are written as a table and as a JSON file, which can be compared with a baseline.
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <map>
+#include <random>
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+
+#include "vns_bpp.h"
+#include "bpp_problem.h"
+
+
+using namespace std;
+using namespace vns_bpp;
+
+
+/*
+ * the BenchmarkInstance is one instance of a set, with its optimum if it is known by construction or given in a file
+ */
+struct BenchmarkInstance{
+    string set_name;
+    string instance_id;
+    long capacity;
+    vector<long> sizes;
+    long optimum; //0 if unknown, the gap is then taken to the lower bound
+};
+
+
+/*
+ * the BenchmarkResult is the outcome of one run of one instance at one time budget
+ */
+struct BenchmarkResult{
+    string set_name;
+    string instance_id;
+    double budget;
+    long items;
+    long bins;
+    long lower_bound;
+    long optimum;
+    double time_to_best; //seconds until the best solution was found
+    double time_spent;
+    long peak_rss_kb; //the peak resident memory of the process which solved the instance
+    bool valid;
+
+    long gap() const { return bins - (optimum > 0 ? optimum : lower_bound); }
+};
+
+
+/*
+ * the InstanceGenerator builds the standard sets from their published parameters, with a fixed seed so every run of the
+ * benchmark solves the same instances. Hard28 is a selection of hard instances, not a generator, so it can only be
+ * given as a problem file with --problems.
+ */
+class InstanceGenerator{
+private:
+    mt19937_64 random_engine;
+    long instances_per_class;
+
+    long uniform(long min, long max){ //fully specified by the seed, unlike the standard distributions
+        return min + (long)(random_engine() % (uint64_t)(max - min + 1));
+    }
+
+    void add_uniform(vector<BenchmarkInstance>* instances, string set_name, string class_name, long capacity, long item_nums,
+                     long min_size, long max_size){
+        for (long instance_index = 0; instance_index < instances_per_class; instance_index++){
+            BenchmarkInstance instance = {set_name, class_name + "_" + to_string(instance_index), capacity, {}, 0};
+            for (long item_index = 0; item_index < item_nums; item_index++){
+                instance.sizes.push_back(uniform(min_size, max_size));
+            }
+            instances->push_back(instance);
+        }
+    }
+
+public:
+    InstanceGenerator(unsigned long seed, long instances_number){
+        random_engine.seed(seed);
+        instances_per_class = instances_number;
+    }
+
+    //Falkenauer uniform: capacity 150, sizes from 20 to 100
+    void falkenauer_u(vector<BenchmarkInstance>* instances){
+        for (long item_nums: {120, 250, 500, 1000}){
+            add_uniform(instances, "falkenauer_u", "u" + to_string(item_nums), 150, item_nums, 20, 100);
+        }
+    }
+
+    //Falkenauer triplets: capacity 1000, each bin of the optimum is filled exactly by three items from 250 to 500
+    void falkenauer_t(vector<BenchmarkInstance>* instances){
+        for (long item_nums: {60, 120, 249, 501}){
+            for (long instance_index = 0; instance_index < instances_per_class; instance_index++){
+                BenchmarkInstance instance = {"falkenauer_t", "t" + to_string(item_nums) + "_" + to_string(instance_index), 1000, {}, item_nums / 3};
+                for (long triplet = 0; triplet < item_nums / 3; triplet++){
+                    long first = uniform(380, 490);
+                    long second = uniform(250, 1000 - first - 250);
+                    instance.sizes.push_back(first);
+                    instance.sizes.push_back(second);
+                    instance.sizes.push_back(1000 - first - second);
+                }
+                shuffle(instance.sizes.begin(), instance.sizes.end(), random_engine);
+                instances->push_back(instance);
+            }
+        }
+    }
+
+    //Scholl set 1: capacities 100 to 150, sizes from 1, 20 or 30 to 100
+    void scholl_1(vector<BenchmarkInstance>* instances){
+        for (long item_nums: {50, 100, 200, 500}){
+            for (long capacity: {100, 120, 150}){
+                for (long min_size: {1, 20, 30}){
+                    add_uniform(instances, "scholl_1", "n" + to_string(item_nums) + "c" + to_string(capacity) + "w" + to_string(min_size),
+                                capacity, item_nums, min_size, 100);
+                }
+            }
+        }
+    }
+
+    //Scholl set 2: capacity 1000, average sizes of a third to a ninth of the capacity, spread by 20%, 50% or 90%
+    void scholl_2(vector<BenchmarkInstance>* instances){
+        for (long item_nums: {50, 100, 200, 500}){
+            for (long divisor: {3, 5, 7, 9}){
+                for (long spread: {20, 50, 90}){
+                    long average = 1000 / divisor;
+                    add_uniform(instances, "scholl_2", "n" + to_string(item_nums) + "w" + to_string(divisor) + "b" + to_string(spread),
+                                1000, item_nums, average - average * spread / 100, average + average * spread / 100);
+                }
+            }
+        }
+    }
+
+    //Scholl set 3: capacity 100000, 200 sizes from 20000 to 35000
+    void scholl_3(vector<BenchmarkInstance>* instances){
+        add_uniform(instances, "scholl_3", "hard", 100000, 200, 20000, 35000);
+    }
+
+    //Schwerin and Waescher: capacity 1000, 100 or 120 sizes from 150 to 200, so about five items fill a bin
+    void schwerin(vector<BenchmarkInstance>* instances){
+        add_uniform(instances, "schwerin", "schwerin1", 1000, 100, 150, 200);
+        add_uniform(instances, "schwerin", "schwerin2", 1000, 120, 150, 200);
+    }
+
+    //Waescher and Gau: capacity 10000, 57 to 239 items of a few sizes up to about half the capacity
+    void waescher(vector<BenchmarkInstance>* instances){
+        for (long instance_index = 0; instance_index < instances_per_class; instance_index++){
+            long item_nums = uniform(57, 239);
+            vector<long> distinct_sizes;
+            for (long size_index = 0; size_index < item_nums / 4; size_index++){
+                distinct_sizes.push_back(uniform(150, 5000));
+            }
+            BenchmarkInstance instance = {"waescher", "w" + to_string(item_nums) + "_" + to_string(instance_index), 10000, {}, 0};
+            for (long item_index = 0; item_index < item_nums; item_index++){
+                instance.sizes.push_back(distinct_sizes[uniform(0, distinct_sizes.size() - 1)]);
+            }
+            instances->push_back(instance);
+        }
+    }
+};
+
+
+//read the instances of a problem file, e.g. a local copy of Hard28, with their best known bins as the optimum
+bool load_problem_file(string problem_file_name, vector<BenchmarkInstance>* instances){
+    ifstream problem_stream(problem_file_name, ios::in);
+    if (!problem_stream.is_open()) {
+        cout << "cannot open file" << endl;
+        return false;
+    }
+    string set_name = problem_file_name.substr(problem_file_name.find_last_of('/') + 1);
+    long num_of_problems = FileReader::read_num_of_instances(problem_stream);
+    for (long problem_counter = 0; problem_counter < num_of_problems; problem_counter++){
+        unique_ptr<ProblemInstance> problem_instance = FileReader::parse_problem_instance(problem_stream);
+        if (!problem_instance) return false;
+        instances->push_back({set_name, problem_instance->get_instance_id(), problem_instance->get_bin_capacity(),
+                              problem_instance->get_item_sizes(), problem_instance->get_best_known_bins()});
+    }
+    return true;
+}
+
+
+//check that every item is packed exactly once and no bin is over the capacity
+bool is_valid_assignment(const BenchmarkInstance& instance, const Assignment& assignment){
+    vector<bool> item_packed(instance.sizes.size(), false);
+    for (auto &bin: assignment.bins){
+        long bin_size = 0;
+        for (long item_index: bin){
+            if (item_index < 0 or item_index >= instance.sizes.size() or item_packed[item_index]) return false;
+            item_packed[item_index] = true;
+            bin_size += instance.sizes[item_index];
+        }
+        if (bin_size > instance.capacity) return false;
+    }
+    return find(item_packed.begin(), item_packed.end(), false) == item_packed.end();
+}
+
+
+//solve the instance in a child process, so its peak memory is measured alone and a crash does not end the benchmark
+BenchmarkResult run_instance(const BenchmarkInstance& instance, double budget, int threads){
+    BenchmarkResult result = {instance.set_name, instance.instance_id, budget, (long)instance.sizes.size(), 0, 0, instance.optimum, 0, 0, 0, false};
+    int result_pipe[2];
+    if (pipe(result_pipe) != 0) return result;
+
+    pid_t child = fork();
+    if (child == 0){
+        close(result_pipe[0]);
+        SolverOptions options;
+        options.max_time = budget;
+        options.threads = threads;
+        options.best_known_bins = instance.optimum;
+        double time_to_best = 0;
+        options.on_improvement = [&time_to_best](const ImprovementEvent& event){ time_to_best = event.time_spent; };
+        Assignment assignment = solve(instance.sizes, instance.capacity, options);
+        ostringstream message;
+        message << assignment.bin_count() << " " << assignment.lower_bound << " " << time_to_best << " "
+                << assignment.time_spent << " " << is_valid_assignment(instance, assignment);
+        string text = message.str();
+        if (write(result_pipe[1], text.c_str(), text.size()) < 0) _exit(1);
+        _exit(0);
+    }
+    close(result_pipe[1]);
+    string text;
+    char buffer[256];
+    ssize_t read_size;
+    while ((read_size = read(result_pipe[0], buffer, sizeof(buffer))) > 0){
+        text.append(buffer, read_size);
+    }
+    close(result_pipe[0]);
+    if (child < 0) return result;
+
+    int status;
+    struct rusage usage;
+    if (wait4(child, &status, 0, &usage) == child){
+        result.peak_rss_kb = usage.ru_maxrss; //kilobytes on Linux
+    }
+    istringstream message(text);
+    int valid = 0;
+    if (message >> result.bins >> result.lower_bound >> result.time_to_best >> result.time_spent >> valid){
+        result.valid = valid == 1;
+    }
+    return result;
+}
+
+
+void print_table(const vector<BenchmarkResult>& results){
+    cout << left << setw(14) << "set" << setw(22) << "instance" << right << setw(8) << "budget" << setw(7) << "items"
+         << setw(7) << "bins" << setw(7) << "bound" << setw(5) << "gap" << setw(10) << "to best" << setw(10) << "rss kB" << endl;
+    for (auto &result: results){
+        cout << left << setw(14) << result.set_name << setw(22) << result.instance_id << right << setw(8) << result.budget
+             << setw(7) << result.items << setw(7) << result.bins << setw(7) << (result.optimum > 0 ? result.optimum : result.lower_bound)
+             << setw(5) << result.gap() << setw(10) << fixed << setprecision(3) << result.time_to_best << defaultfloat
+             << setw(10) << result.peak_rss_kb << (result.valid ? "" : "  INVALID") << endl;
+    }
+
+    //the totals of each budget
+    map<double, long> total_gap, total_bins;
+    for (auto &result: results){
+        total_gap[result.budget] += result.gap();
+        total_bins[result.budget] += result.bins;
+    }
+    for (auto &budget: total_gap){
+        cout << "budget " << budget.first << ": total bins " << total_bins[budget.first] << ", total gap " << budget.second << endl;
+    }
+}
+
+
+//one result per line, so the file can be diffed and read back without a JSON parser
+bool write_json(string json_file_name, const vector<BenchmarkResult>& results){
+    ofstream json_stream(json_file_name, ios::out | ios::trunc);
+    if (!json_stream.is_open()) {
+        cout << "cannot write file" << endl;
+        return false;
+    }
+    json_stream << "{\"results\": [" << endl;
+    for (long result_index = 0; result_index < results.size(); result_index++){
+        const BenchmarkResult &result = results[result_index];
+        json_stream << "{\"set\": \"" << result.set_name << "\", \"instance\": \"" << result.instance_id << "\", \"budget\": " << result.budget
+                    << ", \"items\": " << result.items << ", \"bins\": " << result.bins << ", \"lower_bound\": " << result.lower_bound
+                    << ", \"optimum\": " << result.optimum << ", \"gap\": " << result.gap() << ", \"time_to_best\": " << result.time_to_best
+                    << ", \"time_spent\": " << result.time_spent << ", \"peak_rss_kb\": " << result.peak_rss_kb
+                    << ", \"valid\": " << (result.valid ? "true" : "false") << "}" << (result_index + 1 < results.size() ? "," : "") << endl;
+    }
+    json_stream << "]}" << endl;
+    return true;
+}
+
+
+//the value of a field in a line written by write_json
+string json_field(const string& line, const string& field){
+    size_t start = line.find("\"" + field + "\": ");
+    if (start == string::npos) return "";
+    start += field.size() + 4;
+    if (line[start] == '"'){
+        return line.substr(start + 1, line.find('"', start + 1) - start - 1);
+    }
+    return line.substr(start, line.find_first_of(",}", start) - start);
+}
+
+
+//compare the bins with the baseline, returns the number of runs which lost bins
+long compare_with_baseline(string baseline_file_name, const vector<BenchmarkResult>& results){
+    ifstream baseline_stream(baseline_file_name, ios::in);
+    if (!baseline_stream.is_open()) {
+        cout << "cannot open file" << endl;
+        return -1;
+    }
+    map<string, pair<long, double>> baseline; //the bins and the time to best by set, instance and budget
+    string line;
+    while (getline(baseline_stream, line)){
+        if (json_field(line, "instance").empty()) continue;
+        string key = json_field(line, "set") + " " + json_field(line, "instance") + " " + json_field(line, "budget");
+        baseline[key] = make_pair(atol(json_field(line, "bins").c_str()), atof(json_field(line, "time_to_best").c_str()));
+    }
+
+    long worse = 0, better = 0, compared = 0;
+    cout << endl << "Compared with " << baseline_file_name << ":" << endl;
+    for (auto &result: results){
+        ostringstream budget;
+        budget << result.budget;
+        auto found = baseline.find(result.set_name + " " + result.instance_id + " " + budget.str());
+        if (found == baseline.end()) continue;
+        compared++;
+        long bins_difference = result.bins - found->second.first;
+        if (bins_difference == 0) continue;
+        cout << (bins_difference > 0 ? "  worse:  " : "  better: ") << result.set_name << " " << result.instance_id << " at " << result.budget
+             << "s, " << found->second.first << " -> " << result.bins << " bins" << endl;
+        if (bins_difference > 0) worse++; else better++;
+    }
+    cout << compared << " runs compared, " << better << " better, " << worse << " worse" << endl;
+    return worse;
+}
+
+
+int main(int argc, const char * argv[]) {
+    string sets = "u,t,scholl1,scholl2,scholl3,schwerin,waescher";
+    string budgets = "1,5";
+    vector<string> problem_file_names; //local copies of sets which can not be generated, e.g. Hard28
+    string json_file_name = "benchmark.json";
+    string baseline_file_name;
+    long instances_per_class = 1;
+    unsigned long seed = 1;
+    int threads = 1;
+
+    bool missing_value = false;
+    for(int i=1; i<argc; i++)
+    {
+        if(i+1 >= argc){
+            missing_value = true;
+            break;
+        }
+        if(strcmp(argv[i],"--sets")==0)
+            sets = argv[i+1];
+        else if(strcmp(argv[i],"--budgets")==0)
+            budgets = argv[i+1];
+        else if(strcmp(argv[i],"--problems")==0)
+            problem_file_names.push_back(argv[i+1]);
+        else if(strcmp(argv[i],"--json")==0)
+            json_file_name = argv[i+1];
+        else if(strcmp(argv[i],"--baseline")==0)
+            baseline_file_name = argv[i+1];
+        else if(strcmp(argv[i],"--instances")==0)
+            instances_per_class = atol(argv[i+1]);
+        else if(strcmp(argv[i],"--seed")==0)
+            seed = strtoul(argv[i+1], nullptr, 10);
+        else if(strcmp(argv[i],"--threads")==0)
+            threads = atoi(argv[i+1]);
+        i++;
+    }
+    if (missing_value){
+        printf("Please use the following options:\n   --sets u,t,scholl1,scholl2,scholl3,schwerin,waescher (optional, none for only the files)\n"
+               "   --problems problem_file (optional, repeatable, e.g. Hard28 in the problem file format)\n"
+               "   --budgets seconds,seconds (optional, default 1,5)\n   --instances per_class (optional, default 1)\n"
+               "   --json result_file (optional, default benchmark.json)\n   --baseline result_file (optional)\n"
+               "   --seed seed (optional, default 1)\n   --threads searches_per_instance (optional, default 1)\n");
+        return 1;
+    }
+
+    //generate the sets asked for, each from its own stream so adding a set does not change the others
+    vector<BenchmarkInstance> instances;
+    map<string, void (InstanceGenerator::*)(vector<BenchmarkInstance>*)> generators = {
+        {"u", &InstanceGenerator::falkenauer_u}, {"t", &InstanceGenerator::falkenauer_t}, {"scholl1", &InstanceGenerator::scholl_1},
+        {"scholl2", &InstanceGenerator::scholl_2}, {"scholl3", &InstanceGenerator::scholl_3},
+        {"schwerin", &InstanceGenerator::schwerin}, {"waescher", &InstanceGenerator::waescher}};
+    istringstream sets_stream(sets);
+    string set_name;
+    while (getline(sets_stream, set_name, ',')){
+        if (set_name.empty() or set_name == "none") continue;
+        if (generators.count(set_name) == 0){
+            cout << "unknown set " << set_name << endl;
+            return 1;
+        }
+        InstanceGenerator generator(derive_seed(seed, set_name), instances_per_class);
+        (generator.*generators[set_name])(&instances);
+    }
+    for (auto &problem_file_name: problem_file_names){
+        if (!load_problem_file(problem_file_name, &instances)) return 1;
+    }
+
+    vector<double> budget_seconds;
+    istringstream budgets_stream(budgets);
+    string budget;
+    while (getline(budgets_stream, budget, ',')){
+        if (atof(budget.c_str()) > 0) budget_seconds.push_back(atof(budget.c_str()));
+    }
+    cout << instances.size() << " instances at " << budget_seconds.size() << " budgets" << endl << endl;
+
+    vector<BenchmarkResult> results;
+    for (double budget_second: budget_seconds){
+        for (auto &instance: instances){
+            results.push_back(run_instance(instance, budget_second, threads));
+        }
+    }
+
+    print_table(results);
+    if (!write_json(json_file_name, results)) return 1;
+    cout << "Results written to " << json_file_name << endl;
+
+    bool all_valid = all_of(results.begin(), results.end(), [](const BenchmarkResult& result){ return result.valid; });
+    long worse = baseline_file_name.empty() ? 0 : compare_with_baseline(baseline_file_name, results);
+    return (all_valid and worse == 0) ? 0 : 2;
+}
@@ -0,0 +1,171 @@
+// Author: Feiyang Wang fy916
+// The result cache of the command line interface: the best packing found for each instance is kept in a file under
+// a fingerprint of the capacity and the sizes, so an instance sent again, even with its items in another order,
+// starts from it instead of from scratch.
+
+#ifndef BPP_CACHE_H
+#define BPP_CACHE_H
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <map>
+#include <mutex>
+#include <algorithm>
+#include <cstdint>
+
+#include "vns_bpp.h"
+
+
+using namespace std;
+using namespace vns_bpp;
+
+
+/*
+ * the ResultCache keeps the best packing of each fingerprint as the sizes in each bin, which do not depend on the
+ * order of the items. The cache file has one line per result, appended when a better one is found:
+ *   fingerprint capacity time_spent bins, and for each bin its item count and the item sizes
+ * When the file is loaded, the result with the fewest bins of each fingerprint is kept.
+ */
+class ResultCache{
+private:
+    struct CachedResult{
+        long capacity;
+        vector<vector<long>> bin_sizes; //the sizes of the items in each bin
+        double time_spent; //the seconds the solver spent on it
+    };
+
+    string cache_file_name;
+    map<uint64_t, CachedResult> results;
+    mutex cache_mutex;
+
+    //the FNV-1a hash of the capacity and the sorted sizes
+    static uint64_t fingerprint(long capacity, const vector<long>& sorted_sizes){
+        uint64_t hash = 14695981039346656037ULL;
+        auto add_number = [&hash](long number){
+            for (int byte_index = 0; byte_index < 8; byte_index++){
+                hash = (hash ^ (((uint64_t)number >> (8 * byte_index)) & 0xff)) * 1099511628211ULL;
+            }
+        };
+        add_number(capacity);
+        add_number(sorted_sizes.size());
+        for (long size: sorted_sizes){
+            add_number(size);
+        }
+        return hash;
+    }
+
+    static vector<long> sorted_sizes_of(const vector<vector<long>>& bin_sizes){
+        vector<long> sorted_sizes;
+        for (auto &bin: bin_sizes){
+            sorted_sizes.insert(sorted_sizes.end(), bin.begin(), bin.end());
+        }
+        sort(sorted_sizes.begin(), sorted_sizes.end());
+        return sorted_sizes;
+    }
+
+    //keep the result if it has fewer bins than the one kept for the fingerprint, the caller holds the lock
+    bool keep_locked(uint64_t key, const CachedResult& result){
+        auto found = results.find(key);
+        if (found != results.end() and found->second.bin_sizes.size() <= result.bin_sizes.size()) return false;
+        results[key] = result;
+        return true;
+    }
+
+public:
+    bool open(string cache_f_name){ //load the results of the cache file, which is created at the first result stored
+        lock_guard<mutex> lock(cache_mutex);
+        cache_file_name = cache_f_name;
+        ifstream cache_stream(cache_file_name, ios::in);
+        if (!cache_stream.is_open()) return true;
+
+        string line;
+        while (getline(cache_stream, line)){
+            istringstream line_stream(line);
+            uint64_t key;
+            long bin_nums;
+            CachedResult result;
+            if (!(line_stream >> key >> result.capacity >> result.time_spent >> bin_nums)) continue;
+            bool complete = true;
+            for (long bin_index = 0; bin_index < bin_nums and complete; bin_index++){
+                long item_nums;
+                complete = (bool)(line_stream >> item_nums);
+                vector<long> sizes(max(0L, item_nums));
+                for (long item_index = 0; item_index < item_nums and complete; item_index++){
+                    complete = (bool)(line_stream >> sizes[item_index]);
+                }
+                result.bin_sizes.push_back(sizes);
+            }
+            if (complete) keep_locked(key, result); //a line cut by a killed run is skipped
+        }
+        return true;
+    }
+
+    //look up the packing of the items, mapped back onto their indexes in item_sizes, returns false if there is none
+    bool find(long capacity, const vector<long>& item_sizes, Assignment* assignment, double* time_spent){
+        vector<long> sorted_sizes = item_sizes;
+        sort(sorted_sizes.begin(), sorted_sizes.end());
+        uint64_t key = fingerprint(capacity, sorted_sizes);
+
+        lock_guard<mutex> lock(cache_mutex);
+        auto found = results.find(key);
+        if (found == results.end()) return false;
+        const CachedResult &result = found->second;
+        if (result.capacity != capacity or sorted_sizes_of(result.bin_sizes) != sorted_sizes) return false; //a hash collision
+
+        //give each size of the cached bins one of the items of that size
+        map<long, vector<long>> items_of_size;
+        for (long item_index = item_sizes.size() - 1; item_index >= 0; item_index--){
+            items_of_size[item_sizes[item_index]].push_back(item_index);
+        }
+        *assignment = Assignment();
+        assignment->bin_of_item.assign(item_sizes.size(), -1);
+        for (auto &bin: result.bin_sizes){
+            vector<long> items_in_bin;
+            for (long size: bin){
+                long item_index = items_of_size[size].back();
+                items_of_size[size].pop_back();
+                assignment->bin_of_item[item_index] = assignment->bins.size();
+                items_in_bin.push_back(item_index);
+            }
+            assignment->bins.push_back(items_in_bin);
+        }
+        *time_spent = result.time_spent;
+        return true;
+    }
+
+    //keep the solution of the items if it has fewer bins than the cached one, and append it to the cache file
+    void store(long capacity, const vector<long>& item_sizes, const Assignment& solution){
+        CachedResult result;
+        result.capacity = capacity;
+        result.time_spent = solution.time_spent;
+        for (auto &bin: solution.bins){
+            vector<long> sizes;
+            for (long item_index: bin){
+                sizes.push_back(item_sizes[item_index]);
+            }
+            result.bin_sizes.push_back(sizes);
+        }
+        uint64_t key = fingerprint(capacity, sorted_sizes_of(result.bin_sizes));
+
+        lock_guard<mutex> lock(cache_mutex);
+        if (!keep_locked(key, result)) return;
+        ofstream cache_stream(cache_file_name, ios::out | ios::app);
+        if (!cache_stream.is_open()) {
+            cout << "cannot write file" << endl;
+            return;
+        }
+        cache_stream << key << " " << capacity << " " << result.time_spent << " " << result.bin_sizes.size();
+        for (auto &bin: result.bin_sizes){
+            cache_stream << " " << bin.size();
+            for (long size: bin){
+                cache_stream << " " << size;
+            }
+        }
+        cache_stream << endl;
+    }
+};
+
+#endif //BPP_CACHE_H
@@ -0,0 +1,167 @@
+// Author: Feiyang Wang fy916
+// The periodic checkpoints of the command line interface: the best solution of every running instance is written to a
+// file every few seconds and every finished instance is appended to a journal, so a killed run can be continued
+// with --resume instead of starting again.
+
+#ifndef BPP_CHECKPOINT_H
+#define BPP_CHECKPOINT_H
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <functional>
+#include <cstdio>
+
+#include "vns_bpp.h"
+#include "bpp_problem.h"
+
+
+using namespace std;
+using namespace vns_bpp;
+
+
+/*
+ * the CheckpointWriter keeps the best solution of each running instance and writes them all to the checkpoint file
+ * from a background thread. The file is written to a temporary file first and renamed over the old one,
+ * so the checkpoint file is always complete even if the program is killed while writing.
+ * The finished instances are appended once to the journal file next to it and then forgotten, so the memory and the
+ * cost of each checkpoint follow the instances in flight, not all the instances solved so far.
+ */
+class CheckpointWriter{
+private:
+    struct CheckpointEntry{
+        string instance_id;
+        long best_known_bins;
+        Assignment solution;
+        function<Assignment()> build_solution; //the latest running solution, built by the writer instead of the search
+    };
+
+    string checkpoint_file_name;
+    double interval; //seconds between two writes
+    long instances_num;
+    map<long, CheckpointEntry> entries; //the running instances, by the index of the instance in the problem file
+    vector<CheckpointEntry> finished_entries; //the instances finished since the last write, to append to the journal
+    bool dirty = false; //something changed since the last write
+    bool stopping = false;
+    mutex entries_mutex;
+    condition_variable stop_requested;
+    thread writer;
+
+    void write_periodically(){
+        unique_lock<mutex> lock(entries_mutex);
+        while (!stopping){
+            stop_requested.wait_for(lock, chrono::duration<double>(interval));
+            if (!dirty) continue;
+            write_unlocked(lock);
+        }
+    }
+
+    //take the changes under the lock, and write them without it, the searches reporting their improvements do not
+    //wait for the disk. The journal is appended first, so an instance killed between the two writes is still finished
+    void write_unlocked(unique_lock<mutex> &lock){
+        map<long, CheckpointEntry> entries_to_write = entries;
+        vector<CheckpointEntry> finished_to_append;
+        finished_to_append.swap(finished_entries);
+        dirty = false;
+        lock.unlock();
+        bool appended = append_finished(finished_to_append);
+        bool written = appended and write_entries(entries_to_write);
+        lock.lock();
+        if (!appended){ //try again at the next checkpoint, before the instances finished since
+            finished_entries.insert(finished_entries.begin(), finished_to_append.begin(), finished_to_append.end());
+        }
+        if (!written) dirty = true;
+    }
+
+    bool append_finished(const vector<CheckpointEntry> &finished_to_append){ //without the lock
+        if (finished_to_append.empty()) return true;
+        ofstream journal_stream(journal_file_name(checkpoint_file_name), ios::out | ios::app);
+        if (!journal_stream.is_open()) return false;
+        for (auto &entry: finished_to_append){
+            FileReader::write_solution_block(journal_stream, entry.instance_id, entry.best_known_bins, entry.solution, "finished");
+        }
+        journal_stream.close();
+        return (bool)journal_stream;
+    }
+
+    bool write_entries(map<long, CheckpointEntry>& entries_to_write){ //write the given entries, without the lock
+        for (auto &entry: entries_to_write){
+            if (entry.second.build_solution) entry.second.solution = entry.second.build_solution();
+        }
+        string temporary_file_name = checkpoint_file_name + ".tmp";
+        ofstream checkpoint_stream(temporary_file_name, ios::out | ios::trunc);
+        if (!checkpoint_stream.is_open()) return false;
+
+        checkpoint_stream << instances_num << endl;
+        for (auto &entry: entries_to_write){
+            FileReader::write_solution_block(checkpoint_stream, entry.second.instance_id, entry.second.best_known_bins,
+                                             entry.second.solution, "running");
+        }
+        checkpoint_stream.close();
+        if (!checkpoint_stream) return false;
+        if (rename(temporary_file_name.c_str(), checkpoint_file_name.c_str()) != 0) return false;
+        return true;
+    }
+
+public:
+    //the journal of the finished instances, read after the checkpoint file by --resume
+    static string journal_file_name(string checkpoint_f_name){ return checkpoint_f_name + ".finished"; }
+
+    //a resumed run appends to the journal of the run it continues, a new run starts an empty one
+    CheckpointWriter(string checkpoint_f_name, double interval_seconds, long instances_number, bool resume){
+        checkpoint_file_name = checkpoint_f_name;
+        interval = interval_seconds > 0 ? interval_seconds : 30;
+        instances_num = instances_number;
+        if (!resume){
+            ofstream journal_stream(journal_file_name(checkpoint_file_name), ios::out | ios::trunc);
+        }
+        writer = thread(&CheckpointWriter::write_periodically, this);
+    }
+
+    ~CheckpointWriter(){ //write what is left and stop the writer
+        {
+            lock_guard<mutex> lock(entries_mutex);
+            stopping = true;
+        }
+        stop_requested.notify_all();
+        writer.join();
+        unique_lock<mutex> lock(entries_mutex);
+        if (dirty) write_unlocked(lock);
+    }
+
+    //record the best solution of an instance, it is written at the next checkpoint
+    //a finished instance is appended to the journal once and no longer kept
+    void update(long index, ProblemInstance &instance, const Assignment &solution, bool finished){
+        lock_guard<mutex> lock(entries_mutex);
+        CheckpointEntry entry;
+        entry.instance_id = instance.get_instance_id();
+        entry.best_known_bins = instance.get_best_known_bins();
+        entry.solution = solution;
+        if (finished){
+            entries.erase(index);
+            finished_entries.push_back(entry);
+        }else{
+            entries[index] = entry;
+        }
+        dirty = true;
+    }
+
+    //record a new best solution of a running instance, only the latest one is built, when it is written
+    void update_running(long index, ProblemInstance &instance, function<Assignment()> build_solution){
+        lock_guard<mutex> lock(entries_mutex);
+        CheckpointEntry &entry = entries[index];
+        entry.instance_id = instance.get_instance_id();
+        entry.best_known_bins = instance.get_best_known_bins();
+        entry.solution = Assignment();
+        entry.build_solution = build_solution;
+        dirty = true;
+    }
+};
+
+#endif //BPP_CHECKPOINT_H
@@ -0,0 +1,570 @@
+// Author: Feiyang Wang fy916
+// The problem instances of the command line interface, and the reading and writing of the problem and solution files
+
+#ifndef BPP_PROBLEM_H
+#define BPP_PROBLEM_H
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <map>
+#include <sstream>
+#include <memory>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "vns_bpp.h"
+#include "bpp_cache.h"
+#include "vns_scope_trace.h"
+#include "vns_alloc_stats.h"
+
+
+using namespace std;
+using namespace vns_bpp;
+
+
+/*
+ * the ProblemInstance class represents a problem instance of the BPP problem
+ */
+class ProblemInstance{
+private:
+    vector<long> item_sizes;
+    vector<long> initial_bin_of_item; //the previous solution to start from, empty to solve from scratch
+    Assignment final_solution; //the solution found by the solver
+    ResultCache* result_cache = nullptr; //the packings of the instances solved before, none if not set
+    double cached_time_spent = -1; //the seconds the cached solution took to find, -1 if it was not taken from the cache
+    string instance_id;
+
+    long bin_capacity;
+    long num_of_items;
+    long best_known_bins;
+public:
+    //initialize the property of the problem instance in the constructor
+    ProblemInstance(long bincapacity, long numofitems, long bestknownbins, string instanceid, vector<long> itemSizes){
+        this->bin_capacity = bincapacity;
+        this->num_of_items = numofitems;
+        this->best_known_bins = bestknownbins;
+        this->instance_id = instanceid;
+        this->item_sizes = move(itemSizes);
+    }
+
+    string get_instance_id (){ return instance_id; }
+    long get_bin_capacity(){ return bin_capacity; }
+    long get_num_of_items(){ return num_of_items; }
+    long get_best_known_bins(){ return best_known_bins; }
+    const vector<long>& get_item_sizes(){ return item_sizes; }
+    const Assignment& get_final_solution(){ return final_solution; }
+    void set_warm_start(vector<long> bin_of_item){ initial_bin_of_item = bin_of_item; }
+    void set_final_solution(Assignment solution){ final_solution = solution; } //use a solution found before instead of solving
+    void set_result_cache(ResultCache* cache){ result_cache = cache; }
+
+    //check that every item is packed exactly once and no bin is over the capacity
+    bool is_valid_solution(const Assignment& solution){
+        vector<bool> item_packed(num_of_items, false);
+        for (auto &each_bin: solution.bins){
+            long bin_size = 0;
+            for (long item_ID: each_bin){
+                if (item_ID < 0 or item_ID >= num_of_items or item_packed[item_ID]) return false;
+                item_packed[item_ID] = true;
+                bin_size += item_sizes[item_ID];
+            }
+            if (bin_size > bin_capacity) return false;
+        }
+        for (bool packed: item_packed){
+            if (!packed) return false;
+        }
+        return true;
+    }
+
+    //call this function to use VNS to solve problem
+    void solve_problem(SolverOptions options){
+        cout << "Problem ID: " << instance_id<< endl;
+        solve_problem_quietly(options);
+        cout<<"Time Spent: "<<final_solution.time_spent <<", ";
+        cout<< "My solution bins: " << final_solution.bin_count()<< ", Standard Solution bins: " << best_known_bins<< ", abs_gap: " <<final_solution.bin_count()-best_known_bins;
+        cout<< (final_solution.optimal ? ", proven optimal" : "");
+        if (cached_time_spent >= 0) cout << ", from the cache (solved in " << cached_time_spent << ")";
+        cout << endl;
+    }
+
+    //solve the problem without printing the status, used when several instances are solved at the same time
+    void solve_problem_quietly(SolverOptions options){
+        options.best_known_bins = best_known_bins;
+        if (!initial_bin_of_item.empty()) options.initial_bin_of_item = initial_bin_of_item;
+        cached_time_spent = -1;
+
+        //an instance with the same capacity and sizes solved before is not solved again if its packing meets the
+        //bounds, otherwise the search starts from it unless a warm start is given
+        Assignment cached_solution;
+        if (result_cache != nullptr and result_cache->find(bin_capacity, item_sizes, &cached_solution, &cached_time_spent)){
+            long lower_bound = bins_lower_bound(item_sizes, bin_capacity);
+            if (cached_solution.bin_count() <= max(lower_bound, best_known_bins)){
+                cached_solution.lower_bound = lower_bound;
+                cached_solution.optimal = cached_solution.bin_count() <= lower_bound;
+                final_solution = cached_solution;
+                return;
+            }
+            if (initial_bin_of_item.empty()) options.initial_bin_of_item = cached_solution.bin_of_item;
+            cached_time_spent = -1;
+        }
+
+        final_solution = solve(item_sizes, bin_capacity, options);
+        if (result_cache != nullptr) result_cache->store(bin_capacity, item_sizes, final_solution);
+    }
+};
+
+
+
+
+/*
+ * This BinPackProblem class contains the all the problem instances that to be solved
+ */
+class BinPackProblem{
+private:
+    vector<ProblemInstance> problem_instances;
+
+public:
+    void add_problem_instance(ProblemInstance problem_instance){ problem_instances.push_back(move(problem_instance)); } //add instance to the problem
+
+    void solve_problem_instance(int index, const SolverOptions& options){ //call this function to solve the problem for each instance
+        if (index >=0 and index < problem_instances.size()){
+            problem_instances.at(index).solve_problem(options);
+        }
+    }
+
+    long get_problem_instances_numbers(){ return problem_instances.size();}
+    ProblemInstance& get_problem_instance(int index){ return problem_instances.at(index); }
+    const vector<ProblemInstance>& get_problem_instances(){ return problem_instances; }
+};
+
+
+
+/*
+ * This FileReader deals with the IO to the files
+ */
+class FileReader{
+private:
+    string problem_file_name;
+    string solution_file_name;
+    ifstream problem_file_stream;
+    ofstream solution_file_stream;
+
+public:
+    FileReader(string problem_f_name, string solution_f_name) { //initialize the class with file names
+        problem_file_name = problem_f_name;
+        solution_file_name = solution_f_name;
+    }
+
+    bool load_problem(BinPackProblem *bin_pack_problem) { //load problems to the memory
+        problem_file_stream.open(problem_file_name, ios::in);
+        if (!problem_file_stream.is_open()) {
+            cout << "cannot open file" << endl;
+            return false;
+        }
+
+        long num_of_problems = read_num_of_instances(problem_file_stream); //the number of problems
+
+        //for each problem, load the property
+        for (int problem_counter = 0; problem_counter < num_of_problems; problem_counter++) {
+            read_problem_instance(problem_file_stream, bin_pack_problem);
+        }
+
+        problem_file_stream.close(); //close the stream
+        if(!write_num_of_instances(num_of_problems)){ //write the number of instances to the solution file
+            return false;
+        }
+        return true;
+    }
+
+
+
+    //read the number of instances at the start of a problem stream
+    static long read_num_of_instances(istream &problem_stream){
+        string str;
+        problem_stream >> str;
+        return strtol(str.c_str(), nullptr, 10);
+    }
+
+    //read one problem instance from the stream and add it to the problem, returns false if the stream ends early
+    static bool read_problem_instance(istream &problem_stream, BinPackProblem *bin_pack_problem){
+        unique_ptr<ProblemInstance> problem_instance = parse_problem_instance(problem_stream);
+        if (!problem_instance) return false;
+        bin_pack_problem->add_problem_instance(move(*problem_instance));
+        return true;
+    }
+
+    //read one problem instance from the stream, returns nothing if the stream ends early
+    static unique_ptr<ProblemInstance> parse_problem_instance(istream &problem_stream){
+        VNS_TRACE_SCOPE("read instance");
+        VNS_ALLOC_PHASE("read instance");
+        string str;
+        problem_stream >> str;
+        string instance_id = str;
+
+        problem_stream >> str;
+        long bin_capacity = strtol(str.c_str(), nullptr, 10);
+
+        problem_stream >> str;
+        long num_of_items = strtol(str.c_str(), nullptr, 10);
+
+        problem_stream >> str;
+        long best_known_bins = strtol(str.c_str(), nullptr, 10);
+
+        //add the items, the item ID is the position of the item in the instance
+        vector<long> items_to_add;
+        for (long item_counter = 0; item_counter < num_of_items; item_counter++) {
+            problem_stream >> str;
+            long item_size = strtol(str.c_str(), nullptr, 10);
+            items_to_add.push_back(item_size);
+        }
+        if (!problem_stream) return nullptr;
+
+        //initialize the problem instance for it
+        return unique_ptr<ProblemInstance>(new ProblemInstance(bin_capacity, num_of_items, best_known_bins, instance_id, move(items_to_add)));
+    }
+
+
+
+    bool write_num_of_instances(long instances_num){
+        solution_file_stream.open(solution_file_name,ios::out); //create the file
+        if (!solution_file_stream.is_open()) {
+            cout << "cannot write file" << endl;
+            return false;
+        }
+
+        //write the number of instances to the solution file
+        solution_file_stream << instances_num<< endl;
+        solution_file_stream.close();
+        return true;
+    }
+
+
+
+    //start a shard file instead of a solution file, see ShardMerger
+    bool write_shard_header(long shard_index, long shard_nums, long instances_num){
+        solution_file_stream.open(solution_file_name,ios::out); //create the file
+        if (!solution_file_stream.is_open()) {
+            cout << "cannot write file" << endl;
+            return false;
+        }
+        solution_file_stream << "shard " << shard_index << "/" << shard_nums << " of " << instances_num << endl;
+        solution_file_stream.close();
+        return true;
+    }
+
+    //write solution to the file, the index of the instance in the problem file is only written to the shard files
+    bool write_solution(ProblemInstance &current_inst, long instance_index = -1) {
+        VNS_TRACE_SCOPE("write solution");
+        VNS_ALLOC_PHASE("write solution");
+        solution_file_stream.open(solution_file_name,ios::app);//use append method
+        if (!solution_file_stream.is_open()) {
+            cout << "cannot write file" << endl;
+            return false;
+        }
+
+        if (instance_index >= 0) solution_file_stream << "instance index = " << instance_index << endl;
+        write_solution_block(solution_file_stream, current_inst);
+        solution_file_stream.close();
+        return true;
+    }
+
+    //write the solutions of several instances at once, e.g. those of a batch of small instances, with their index
+    //in the problem file if instance_indexes is given
+    bool write_solutions(const vector<ProblemInstance*>& instances, const vector<long>& instance_indexes) {
+        VNS_TRACE_SCOPE("write solution");
+        VNS_ALLOC_PHASE("write solution");
+        solution_file_stream.open(solution_file_name,ios::app);//use append method
+        if (!solution_file_stream.is_open()) {
+            cout << "cannot write file" << endl;
+            return false;
+        }
+
+        for (long instance_index = 0; instance_index < instances.size(); instance_index++){
+            if (!instance_indexes.empty()) solution_file_stream << "instance index = " << instance_indexes[instance_index] << "\n";
+            write_solution_block(solution_file_stream, *instances[instance_index]);
+        }
+        solution_file_stream.close();
+        return true;
+    }
+
+    //write the solution of one instance to the stream, in the solution file format
+    static void write_solution_block(ostream &solution_stream, ProblemInstance &current_inst){
+        write_solution_block(solution_stream, current_inst.get_instance_id(), current_inst.get_best_known_bins(),
+                             current_inst.get_final_solution(), "");
+    }
+
+    //write a solution to the stream, the status line is only written to the checkpoint files
+    static void write_solution_block(ostream &solution_stream, string instance_id, long best_known_bins,
+                                     const Assignment& curr_sln, string status){
+        //write the id, objectives to the file, the lines are not flushed one by one, the callers close the stream
+        solution_stream << "instance ID = " << instance_id << "\n";
+        if (!status.empty()) solution_stream << "status = " << status << "\n";
+        solution_stream << "solution bins =   "<< curr_sln.bin_count() << "\n" ;
+        solution_stream << "expected bins =   "<< best_known_bins << "\n";
+        solution_stream << "difference =   "<< curr_sln.bin_count()-best_known_bins << "\n";
+
+        //write the solution to the file
+        int bin_counter = 0;
+        for (auto &each_bin: curr_sln.bins){//items in each bin in the same line
+            solution_stream << "Bin ID: " << bin_counter << " --- Item ID: ";
+            for (auto item_ID: each_bin){
+                solution_stream <<item_ID << " ";
+            }
+            solution_stream << "\n";
+            bin_counter ++;
+        }
+    }
+};
+
+
+
+
+
+
+/*
+ * This WarmStartLoader reads previous solutions to start the search from.
+ * It reads either a solution file written by FileReader, or a binary assignment file which starts with "VNSBPPA1"
+ * followed by one record per instance: the length of the instance ID, the instance ID, the number of items,
+ * and the bin index of each item (-1 if not assigned), all numbers as 64-bit little endian integers.
+ * The checkpoint files are solution files with an extra "status = finished" line for the instances already solved.
+ */
+class WarmStartLoader{
+private:
+    map<string, vector<vector<long>>> previous_bins; //the item IDs in each bin, by instance ID
+    map<string, bool> finished; //the instances whose search had ended when the checkpoint was written
+
+    bool load_solution_file(ifstream &solution_stream){
+        string line;
+        vector<vector<long>>* current_bins = nullptr;
+        string current_id;
+        while (getline(solution_stream, line)){
+            if (line.compare(0, 14, "instance ID = ") == 0){ //a new instance starts
+                current_id = line.substr(14);
+                current_bins = &previous_bins[current_id];
+                current_bins->clear();
+                finished[current_id] = false;
+            } else if (line == "status = finished" and current_bins != nullptr){
+                finished[current_id] = true;
+            } else if (line.compare(0, 7, "Bin ID:") == 0 and current_bins != nullptr){
+                size_t items_start = line.find("Item ID:");
+                if (items_start == string::npos) continue;
+                istringstream items_stream(line.substr(items_start + 8));
+                vector<long> items_in_bin;
+                long item_ID;
+                while (items_stream >> item_ID) items_in_bin.push_back(item_ID);
+                current_bins->push_back(items_in_bin);
+            }
+        }
+        return true;
+    }
+
+    static bool read_number(ifstream &assignment_stream, int64_t *number){
+        unsigned char bytes[8];
+        if (!assignment_stream.read((char*)bytes, 8)) return false;
+        uint64_t value = 0;
+        for (int byte_index = 7; byte_index >= 0; byte_index--) value = (value << 8) | bytes[byte_index];
+        *number = (int64_t)value;
+        return true;
+    }
+
+    //the lengths are checked against the bytes left in the file before anything is allocated from them,
+    //so a corrupt or truncated file is rejected instead of asking for a huge string or bins
+    bool load_assignment_file(ifstream &assignment_stream, int64_t file_size){
+        const int64_t max_id_length = 4096;
+        int64_t id_length, num_of_items;
+        while (read_number(assignment_stream, &id_length)){
+            int64_t bytes_left = file_size - (int64_t)assignment_stream.tellg();
+            if (id_length <= 0 or id_length > max_id_length or id_length > bytes_left) return false;
+            string instance_id(id_length, ' ');
+            if (!assignment_stream.read(&instance_id[0], id_length) or !read_number(assignment_stream, &num_of_items)){
+                return false;
+            }
+            bytes_left = file_size - (int64_t)assignment_stream.tellg();
+            if (num_of_items < 0 or num_of_items > bytes_left / 8) return false; //every item takes 8 bytes
+            vector<vector<long>> &bins = previous_bins[instance_id];
+            bins.clear();
+            for (int64_t item_ID = 0; item_ID < num_of_items; item_ID++){
+                int64_t bin_index;
+                if (!read_number(assignment_stream, &bin_index)) return false;
+                if (bin_index < 0 or bin_index >= num_of_items) continue; //the item was not assigned
+                if (bins.size() <= bin_index) bins.resize(bin_index + 1);
+                bins[bin_index].push_back(item_ID);
+            }
+        }
+        return true;
+    }
+
+public:
+    bool load(string file_name){ //load the previous solutions, the file type is detected from its start
+        ifstream warm_start_stream(file_name, ios::in | ios::binary);
+        if (!warm_start_stream.is_open()) {
+            cout << "cannot open file" << endl;
+            return false;
+        }
+        char magic[8] = {0};
+        warm_start_stream.read(magic, 8);
+        if (warm_start_stream and memcmp(magic, "VNSBPPA1", 8) == 0){
+            warm_start_stream.seekg(0, ios::end);
+            int64_t file_size = warm_start_stream.tellg();
+            warm_start_stream.seekg(8);
+            if (!load_assignment_file(warm_start_stream, file_size)){
+                cout << "cannot load file, the assignment file is corrupt or truncated" << endl;
+                previous_bins.clear(); //none of the file is used
+                return false;
+            }
+            return true;
+        }
+        warm_start_stream.clear();
+        warm_start_stream.seekg(0);
+        return load_solution_file(warm_start_stream);
+    }
+
+    bool has_instance(string instance_id){ return previous_bins.count(instance_id) > 0; }
+    bool is_finished(string instance_id){ return finished.count(instance_id) > 0 and finished[instance_id]; }
+
+    //the previous solution of the instance as it was written
+    Assignment get_assignment(string instance_id, long num_of_items){
+        Assignment assignment;
+        assignment.bins = previous_bins[instance_id];
+        assignment.bin_of_item = get_bin_of_item(instance_id, num_of_items);
+        return assignment;
+    }
+
+    //the bin of each item of the instance in the previous solution, the item IDs which do not exist anymore are dropped
+    vector<long> get_bin_of_item(string instance_id, long num_of_items){
+        vector<long> bin_of_item(num_of_items, -1);
+        const vector<vector<long>> &bins = previous_bins[instance_id];
+        for (long bin_index = 0; bin_index < bins.size(); bin_index++){
+            for (long item_ID: bins[bin_index]){
+                if (item_ID >= 0 and item_ID < num_of_items) bin_of_item[item_ID] = bin_index;
+            }
+        }
+        return bin_of_item;
+    }
+
+    //set the previous solution as the starting point of the instance, returns false if there is none
+    bool apply_to(ProblemInstance &instance){
+        if (!has_instance(instance.get_instance_id())) return false;
+        instance.set_warm_start(get_bin_of_item(instance.get_instance_id(), instance.get_num_of_items()));
+        return true;
+    }
+
+    //use the finished solution of a checkpoint as the final solution, returns false if the instance needs more search
+    bool apply_finished_to(ProblemInstance &instance){
+        if (!is_finished(instance.get_instance_id())) return false;
+        Assignment assignment = get_assignment(instance.get_instance_id(), instance.get_num_of_items());
+        if (!instance.is_valid_solution(assignment)) return false; //the problem file has changed, search again
+        instance.set_final_solution(assignment);
+        return true;
+    }
+
+    //set the previous solutions as the starting points of the instances of the problem, returns the number of instances found
+    long apply(BinPackProblem *bin_pack_problem){
+        long warm_started = 0;
+        for (long index = 0; index < bin_pack_problem->get_problem_instances_numbers(); index++){
+            if (apply_to(bin_pack_problem->get_problem_instance(index))) warm_started++;
+        }
+        return warm_started;
+    }
+};
+
+
+
+/*
+ * the ProblemPipeline reads the instances of a problem file on its own thread, a few instances ahead of the solver,
+ * so the parsing is hidden behind the solving and only the instances waiting to be solved are held in memory
+ */
+class ProblemPipeline{
+private:
+    ifstream problem_file_stream;
+    long instances_num = 0;
+    long read_ahead;
+    deque<unique_ptr<ProblemInstance>> ready_instances; //parsed and waiting for the solver
+    bool reading_done = false;
+    bool stopping = false;
+    mutex queue_mutex;
+    condition_variable queue_changed;
+    thread reader;
+
+    void read_instances(){
+        for (long problem_counter = 0; problem_counter < instances_num; problem_counter++){
+            unique_ptr<ProblemInstance> instance = FileReader::parse_problem_instance(problem_file_stream);
+            if (!instance) break;
+            unique_lock<mutex> lock(queue_mutex);
+            queue_changed.wait(lock, [this]{ return stopping or ready_instances.size() < read_ahead; });
+            if (stopping) break;
+            ready_instances.push_back(move(instance));
+            queue_changed.notify_all();
+        }
+        lock_guard<mutex> lock(queue_mutex);
+        reading_done = true;
+        queue_changed.notify_all();
+    }
+
+public:
+    ProblemPipeline(long instances_ahead){
+        read_ahead = max(1L, instances_ahead);
+    }
+
+    ~ProblemPipeline(){ //stop the reader, even if not all the instances were taken
+        {
+            lock_guard<mutex> lock(queue_mutex);
+            stopping = true;
+        }
+        queue_changed.notify_all();
+        if (reader.joinable()) reader.join();
+    }
+
+    bool open(string problem_file_name){ //read the number of instances and start reading the instances
+        problem_file_stream.open(problem_file_name, ios::in);
+        if (!problem_file_stream.is_open()) {
+            cout << "cannot open file" << endl;
+            return false;
+        }
+        instances_num = FileReader::read_num_of_instances(problem_file_stream);
+        reader = thread(&ProblemPipeline::read_instances, this);
+        return true;
+    }
+
+    long get_instances_number(){ return instances_num; }
+
+    //the next instance of the file, waiting for the reader if needed, or nothing after the last one
+    unique_ptr<ProblemInstance> next(){
+        unique_lock<mutex> lock(queue_mutex);
+        queue_changed.wait(lock, [this]{ return reading_done or !ready_instances.empty(); });
+        if (ready_instances.empty()) return nullptr;
+        unique_ptr<ProblemInstance> instance = move(ready_instances.front());
+        ready_instances.pop_front();
+        queue_changed.notify_all();
+        return instance;
+    }
+};
+
+
+
+//if the solution could not be written to file, print to the terminal
+inline void print_solution(ProblemInstance &current_inst){
+    //get the solution
+    const Assignment& curr_sln = current_inst.get_final_solution();
+
+    //print the id, objectives to the file
+    cout << current_inst.get_instance_id() << endl;
+    cout << " obj=   "<< curr_sln.bin_count() << " \t " << curr_sln.bin_count()-current_inst.get_best_known_bins() << endl;
+    //print the solution to the file
+    for (auto &each_bin: curr_sln.bins){//items in each bin in the same line
+        for (auto item_ID: each_bin){
+            cout<< item_ID << " ";
+        }
+        cout<< endl;
+    }
+    cout<< endl<<endl;
+
+}
+
+#endif //BPP_PROBLEM_H
@@ -0,0 +1,82 @@
+// Author: Feiyang Wang fy916
+// The time budget scheduler of the command line interface: with a total time for the whole problem file, each
+// instance gets a slice by its difficulty, the time the easy ones do not use goes to the later ones, and what is
+// kept back at the end goes to the instances which were still improving when their slice ran out.
+
+#ifndef BPP_SCHEDULER_H
+#define BPP_SCHEDULER_H
+
+#include <chrono>
+#include <algorithm>
+
+#include "vns_bpp.h"
+#include "bpp_problem.h"
+
+
+using namespace std;
+using namespace vns_bpp;
+
+
+/*
+ * the TimeBudgetScheduler shares the total time over the instances in two passes.
+ * In the first pass the instances come one by one, and each gets the first pass time left in proportion to its
+ * difficulty, counting the instances not started yet as being as difficult as the average so far.
+ * In the second pass the time left is shared over the instances still improving, by the bins they may still save.
+ */
+class TimeBudgetScheduler{
+private:
+    double total_time; //seconds for the whole problem file, the writing of the solutions included
+    long instances_nums; //the instances to solve in the first pass
+    long instances_started = 0;
+    double difficulty_sum = 0; //of the instances started
+    chrono::steady_clock::time_point time_start;
+
+public:
+    double second_pass_share = 0.2; //the share of the total time kept back for the second pass
+    double writing_time = 2; //the seconds kept at the end to write the solutions
+
+    TimeBudgetScheduler(double total_seconds, long instances_number){
+        total_time = total_seconds;
+        instances_nums = instances_number;
+        time_start = chrono::steady_clock::now();
+    }
+
+    //the bins the best fit decreasing packing may be above the optimum, plus one so the easy instances still get some time
+    static double difficulty(ProblemInstance &instance){
+        long upper_bound = best_fit_decreasing_bins(instance.get_item_sizes(), instance.get_bin_capacity());
+        long lower_bound = bins_lower_bound(instance.get_item_sizes(), instance.get_bin_capacity());
+        return 1 + max(0L, upper_bound - lower_bound);
+    }
+
+    //the seconds left for solving
+    double time_left(){
+        double elapsed = chrono::duration<double>(chrono::steady_clock::now() - time_start).count();
+        return max(0.0, total_time - writing_time - elapsed);
+    }
+
+    //the slice of the next instance of the first pass
+    double first_pass_slice(double instance_difficulty){
+        instances_started++;
+        difficulty_sum += instance_difficulty;
+        double first_pass_left = time_left() - (total_time - writing_time) * second_pass_share;
+        double average_difficulty = difficulty_sum / instances_started;
+        long instances_after = max(0L, instances_nums - instances_started);
+        return max(0.0, first_pass_left * instance_difficulty / (instance_difficulty + average_difficulty * instances_after));
+    }
+
+    void skip(){ instances_nums--; } //an instance which is not solved in the first pass, e.g. finished in the checkpoint
+
+    //the slice of the next instance of the second pass, given the bins it may save and those of the instances after it
+    double second_pass_slice(double bins_to_save, double bins_to_save_after){
+        return time_left() * bins_to_save / (bins_to_save + bins_to_save_after);
+    }
+
+    //an instance is still improving if it found a better solution in the last half of its slice
+    static bool still_improving(ProblemInstance &instance, double last_improvement, double slice){
+        const Assignment &solution = instance.get_final_solution();
+        if (solution.optimal or solution.bin_count() <= max(solution.lower_bound, instance.get_best_known_bins())) return false;
+        return last_improvement >= slice / 2;
+    }
+};
+
+#endif //BPP_SCHEDULER_H
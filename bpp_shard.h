@@ -0,0 +1,171 @@
+// Author: Feiyang Wang fy916
+// The sharding of the command line interface: with --shard i/N, each of N processes solves a part of the problem file,
+// balanced by the item counts, and writes a shard file; the merge command puts the shard files back together into
+// the solution file of the whole problem file, in the order of the instances.
+
+#ifndef BPP_SHARD_H
+#define BPP_SHARD_H
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <map>
+#include <algorithm>
+#include <cstdio>
+
+#include "bpp_problem.h"
+
+
+using namespace std;
+
+
+/*
+ * the ShardPlan gives each instance of the problem file to a shard with the longest processing time first rule:
+ * from the instance with the most items, each instance goes to the shard with the fewest items so far.
+ * Every process makes the same plan from the same file, so they need not talk to each other.
+ */
+class ShardPlan{
+private:
+    long shard_index = 0; //the shard of this process, from 0
+    long shard_nums = 1;
+    vector<long> shard_of_instance;
+    long instances_in_shard = 0;
+
+public:
+    //parse "i/N" with 0 <= i < N
+    bool parse(string shard_spec){
+        size_t slash = shard_spec.find('/');
+        if (slash == string::npos) return false;
+        shard_index = strtol(shard_spec.substr(0, slash).c_str(), nullptr, 10);
+        shard_nums = strtol(shard_spec.substr(slash + 1).c_str(), nullptr, 10);
+        return shard_nums > 0 and shard_index >= 0 and shard_index < shard_nums;
+    }
+
+    //read the item count of each instance, skipping the sizes, and share the instances over the shards
+    bool plan(string problem_file_name){
+        ifstream problem_stream(problem_file_name, ios::in);
+        if (!problem_stream.is_open()) {
+            cout << "cannot open file" << endl;
+            return false;
+        }
+        long num_of_problems = FileReader::read_num_of_instances(problem_stream);
+        vector<long> item_counts;
+        for (long problem_counter = 0; problem_counter < num_of_problems; problem_counter++){
+            string instance_id;
+            long bin_capacity, num_of_items, best_known_bins, item_size;
+            if (!(problem_stream >> instance_id >> bin_capacity >> num_of_items >> best_known_bins)) break;
+            for (long item_counter = 0; item_counter < num_of_items; item_counter++){
+                problem_stream >> item_size;
+            }
+            item_counts.push_back(num_of_items);
+        }
+
+        vector<long> largest_first(item_counts.size());
+        for (long instance_index = 0; instance_index < item_counts.size(); instance_index++){
+            largest_first[instance_index] = instance_index;
+        }
+        stable_sort(largest_first.begin(), largest_first.end(), [&item_counts](long instance_a, long instance_b){
+            return item_counts[instance_a] > item_counts[instance_b];
+        });
+        vector<long> shard_items(shard_nums, 0);
+        shard_of_instance.assign(item_counts.size(), 0);
+        instances_in_shard = 0;
+        for (long instance_index: largest_first){
+            long lightest_shard = min_element(shard_items.begin(), shard_items.end()) - shard_items.begin();
+            shard_of_instance[instance_index] = lightest_shard;
+            shard_items[lightest_shard] += item_counts[instance_index];
+            if (lightest_shard == shard_index) instances_in_shard++;
+        }
+        return true;
+    }
+
+    bool contains(long instance_index){
+        return instance_index < shard_of_instance.size() and shard_of_instance[instance_index] == shard_index;
+    }
+    long get_instances_in_shard(){ return instances_in_shard; }
+    long get_shard_index(){ return shard_index; }
+    long get_shard_nums(){ return shard_nums; }
+};
+
+
+/*
+ * the ShardMerger reads the shard files, each made of the line "shard i/N of total_instances" and the solution blocks
+ * of its instances, each preceded by "instance index = k", and writes the solution file of the whole problem file
+ */
+class ShardMerger{
+private:
+    long instances_num = -1;
+    long shard_nums = -1;
+    map<long, string> blocks; //the solution block of each instance, by its index in the problem file
+
+    bool read_shard(string shard_file_name){
+        ifstream shard_stream(shard_file_name, ios::in);
+        if (!shard_stream.is_open()) {
+            cout << "cannot open file " << shard_file_name << endl;
+            return false;
+        }
+        string line;
+        long shard_index, shards, instances;
+        if (!getline(shard_stream, line) or sscanf(line.c_str(), "shard %ld/%ld of %ld", &shard_index, &shards, &instances) != 3){
+            cout << shard_file_name << " is not a shard file" << endl;
+            return false;
+        }
+        if ((instances_num >= 0 and instances != instances_num) or (shard_nums >= 0 and shards != shard_nums)){
+            cout << shard_file_name << " is a shard of another run" << endl;
+            return false;
+        }
+        instances_num = instances;
+        shard_nums = shards;
+
+        string* block = nullptr;
+        while (getline(shard_stream, line)){
+            long instance_index;
+            if (sscanf(line.c_str(), "instance index = %ld", &instance_index) == 1){
+                if (blocks.count(instance_index) > 0){
+                    cout << "instance " << instance_index << " is in more than one shard" << endl;
+                    return false;
+                }
+                block = &blocks[instance_index];
+            } else if (block != nullptr){
+                block->append(line).append("\n");
+            }
+        }
+        return true;
+    }
+
+public:
+    //merge the shard files into the solution file, fails if an instance is missing or solved twice
+    bool merge(const vector<string>& shard_file_names, string solution_file_name){
+        for (auto &shard_file_name: shard_file_names){
+            if (!read_shard(shard_file_name)) return false;
+        }
+        for (long instance_index = 0; instance_index < instances_num; instance_index++){
+            if (blocks.count(instance_index) == 0){
+                cout << "instance " << instance_index << " is in none of the shards" << endl;
+                return false;
+            }
+        }
+        if (blocks.size() != instances_num){
+            cout << "the shards have instances beyond the " << instances_num << " of the problem file" << endl;
+            return false;
+        }
+
+        FileReader filereader("", solution_file_name);
+        if (!filereader.write_num_of_instances(instances_num)) return false;
+        ofstream solution_stream(solution_file_name, ios::app);
+        if (!solution_stream.is_open()) {
+            cout << "cannot write file" << endl;
+            return false;
+        }
+        for (auto &block: blocks){
+            solution_stream << block.second;
+        }
+        return (bool)solution_stream;
+    }
+
+    long get_instances_number(){ return instances_num; }
+};
+
+#endif //BPP_SHARD_H
@@ -0,0 +1,54 @@
+// Author: Feiyang Wang fy916
+// The improvement trace of the command line interface: every new best solution found by the search is written
+// to a trace file with its time, so time-to-target curves can be drawn to choose the time budget of each instance class.
+
+#ifndef BPP_TRACE_H
+#define BPP_TRACE_H
+
+#include <iostream>
+#include <string>
+#include <fstream>
+#include <mutex>
+
+#include "vns_bpp.h"
+
+
+using namespace std;
+using namespace vns_bpp;
+
+
+/*
+ * the ImprovementTrace writes one comma separated line per improvement event:
+ * instance ID, seconds since the instance was started, bins, sum of square of the remaining sizes, and the neighbourhood
+ */
+class ImprovementTrace{
+private:
+    ofstream trace_stream;
+    mutex trace_mutex;
+
+public:
+    bool open(string trace_file_name){ //create the trace file and write the header line
+        trace_stream.open(trace_file_name, ios::out | ios::trunc);
+        if (!trace_stream.is_open()) {
+            cout << "cannot write file" << endl;
+            return false;
+        }
+        trace_stream << "instance_id,time,bins,sum_of_squares,neighbourhood" << endl;
+        return true;
+    }
+
+    bool is_open(){ return trace_stream.is_open(); }
+
+    void write(string instance_id, const ImprovementEvent& event){
+        lock_guard<mutex> lock(trace_mutex);
+        trace_stream << instance_id << "," << event.time_spent << "," << event.bins << ","
+                     << event.sum_of_squares << "," << event.neighbourhood << "\n";
+    }
+
+    void flush(){ //called after each instance, so the trace of the finished instances is kept if the run is killed
+        lock_guard<mutex> lock(trace_mutex);
+        trace_stream.flush();
+    }
+};
+
+#endif //BPP_TRACE_H
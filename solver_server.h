@@ -0,0 +1,269 @@
+// Author: Feiyang Wang fy916
+// The server mode of the command line interface: a long running solver listening on a Unix domain socket.
+// A client sends requests in the problem file format, optionally preceded by "deadline <seconds>",
+// and receives the solutions in the solution file format, one instance after another as soon as each is solved.
+
+#ifndef SOLVER_SERVER_H
+#define SOLVER_SERVER_H
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <deque>
+#include <sstream>
+#include <chrono>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "vns_bpp.h"
+#include "bpp_problem.h"
+
+
+using namespace std;
+using namespace vns_bpp;
+
+
+/*
+ * the WorkerPool keeps a fixed set of threads alive which run the submitted tasks in order
+ */
+class WorkerPool{
+private:
+    vector<thread> workers;
+    deque<function<void()>> tasks; //the tasks waiting for a worker
+    mutex tasks_mutex;
+    condition_variable tasks_changed;
+    bool stopping = false;
+
+    void work(){ //the loop of each worker, take the next task and run it
+        while(true){
+            function<void()> task;
+            {
+                unique_lock<mutex> lock(tasks_mutex);
+                tasks_changed.wait(lock, [this]{ return stopping or !tasks.empty(); });
+                if (tasks.empty()) return; //stopping and nothing left to do
+                task = tasks.front();
+                tasks.pop_front();
+            }
+            task();
+        }
+    }
+
+public:
+    WorkerPool(int worker_nums){
+        for (int worker_index = 0; worker_index < worker_nums; worker_index++){
+            workers.push_back(thread(&WorkerPool::work, this));
+        }
+    }
+
+    ~WorkerPool(){ //finish the waiting tasks and stop the workers
+        {
+            lock_guard<mutex> lock(tasks_mutex);
+            stopping = true;
+        }
+        tasks_changed.notify_all();
+        for (auto &worker: workers) worker.join();
+    }
+
+    void submit(function<void()> task){
+        {
+            lock_guard<mutex> lock(tasks_mutex);
+            tasks.push_back(task);
+        }
+        tasks_changed.notify_one();
+    }
+};
+
+
+/*
+ * the SocketStreamBuf lets the problem reader and solution writer of FileReader work directly on a connected socket
+ */
+class SocketStreamBuf : public streambuf{
+private:
+    int socket_fd;
+    char read_buffer[65536];
+    char write_buffer[65536];
+
+    bool send_all(const char* data, long size){ //send the whole buffer, the socket may take it in parts
+        while (size > 0){
+            long sent = send(socket_fd, data, size, MSG_NOSIGNAL);
+            if (sent <= 0) return false;
+            data += sent;
+            size -= sent;
+        }
+        return true;
+    }
+
+protected:
+    int_type underflow() override { //refill the read buffer from the socket
+        long received = recv(socket_fd, read_buffer, sizeof(read_buffer), 0);
+        if (received <= 0) return traits_type::eof();
+        setg(read_buffer, read_buffer, read_buffer + received);
+        return traits_type::to_int_type(read_buffer[0]);
+    }
+
+    int_type overflow(int_type c) override { //the write buffer is full, send it
+        if (sync() != 0) return traits_type::eof();
+        if (!traits_type::eq_int_type(c, traits_type::eof())){
+            *pptr() = traits_type::to_char_type(c);
+            pbump(1);
+        }
+        return traits_type::not_eof(c);
+    }
+
+    int sync() override { //send what has been written so far
+        long size = pptr() - pbase();
+        if (size > 0 and !send_all(pbase(), size)) return -1;
+        setp(write_buffer, write_buffer + sizeof(write_buffer));
+        return 0;
+    }
+
+public:
+    SocketStreamBuf(int fd){
+        socket_fd = fd;
+        setg(read_buffer, read_buffer, read_buffer);
+        setp(write_buffer, write_buffer + sizeof(write_buffer));
+    }
+};
+
+
+/*
+ * the SolverServer accepts connections on a Unix domain socket and solves the requests on a persistent worker pool
+ */
+class SolverServer{
+private:
+    string socket_path;
+    double default_max_time; //the deadline of a request which does not give one, in seconds
+    unsigned long seed; //each instance derives its random numbers from it and its ID
+    WorkerPool worker_pool;
+
+    //serve the requests of one client until it closes the connection
+    void serve_connection(int connection_fd){
+        SocketStreamBuf socket_buffer(connection_fd);
+        istream request_stream(&socket_buffer);
+        ostream response_stream(&socket_buffer);
+
+        while(true){
+            string str;
+            if (!(request_stream >> str)) break; //the client has no more requests
+            chrono::steady_clock::time_point request_start = chrono::steady_clock::now();
+
+            //the optional deadline of the request
+            double max_time = default_max_time;
+            if (str == "deadline"){
+                request_stream >> str;
+                max_time = strtod(str.c_str(), nullptr);
+                request_stream >> str;
+            }
+            long num_of_problems = strtol(str.c_str(), nullptr, 10);
+
+            //read the instances of the request and hand them to the workers as soon as each is read
+            vector<shared_ptr<BinPackProblem>> instances;
+            vector<future<void>> solved;
+            bool request_complete = true;
+            for (long problem_counter = 0; problem_counter < num_of_problems; problem_counter++){
+                shared_ptr<BinPackProblem> instance = make_shared<BinPackProblem>();
+                if (!FileReader::read_problem_instance(request_stream, instance.get())){
+                    request_complete = false;
+                    break;
+                }
+                shared_ptr<promise<void>> done = make_shared<promise<void>>();
+                solved.push_back(done->get_future());
+                instances.push_back(instance);
+
+                unsigned long instance_seed = derive_seed(seed, instance->get_problem_instance(0).get_instance_id());
+                worker_pool.submit([instance, done, request_start, max_time, instance_seed]{
+                    //the deadline counts from the arrival of the request, not from the start of the task
+                    SolverOptions options;
+                    double waited = chrono::duration<double>(chrono::steady_clock::now() - request_start).count();
+                    options.max_time = max(0.0, max_time - waited);
+                    options.seed = instance_seed;
+                    try{
+                        instance->get_problem_instance(0).solve_problem_quietly(options);
+                        done->set_value();
+                    }catch (...){ //the failure goes back to the client, the worker and the server keep running
+                        done->set_exception(current_exception());
+                    }
+                });
+            }
+
+            //stream the solutions back in the order of the request
+            response_stream << instances.size() << endl;
+            for (long instance_index = 0; instance_index < instances.size(); instance_index++){
+                ProblemInstance &current_inst = instances[instance_index]->get_problem_instance(0);
+                ostringstream solution_block; //format the whole block first, so it is sent at once
+                try{
+                    solved[instance_index].get();
+                    FileReader::write_solution_block(solution_block, current_inst);
+                }catch (const exception& e){ //a failed instance is answered with no bins and the reason in its status
+                    FileReader::write_solution_block(solution_block, current_inst.get_instance_id(), current_inst.get_best_known_bins(),
+                                                     Assignment(), string("failed: ") + e.what());
+                }catch (...){
+                    FileReader::write_solution_block(solution_block, current_inst.get_instance_id(), current_inst.get_best_known_bins(),
+                                                     Assignment(), "failed");
+                }
+                response_stream << solution_block.str() << flush;
+            }
+            if (!request_complete or !response_stream) break;
+        }
+        close(connection_fd);
+    }
+
+public:
+    SolverServer(string socket_f_path, double max_time, int worker_nums, unsigned long random_seed) : worker_pool(max(1, worker_nums)){
+        socket_path = socket_f_path;
+        default_max_time = max_time;
+        seed = random_seed;
+    }
+
+    bool run(){ //listen on the socket and serve the clients, only returns if the socket can not be set up
+        int listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listen_fd < 0){
+            cout << "cannot create socket" << endl;
+            return false;
+        }
+
+        sockaddr_un address;
+        memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        if (socket_path.size() >= sizeof(address.sun_path)){
+            cout << "socket path too long" << endl;
+            close(listen_fd);
+            return false;
+        }
+        strcpy(address.sun_path, socket_path.c_str());
+
+        //remove the socket left by a previous server, but never a file which is not a socket
+        struct stat path_status;
+        if (lstat(socket_path.c_str(), &path_status) == 0){
+            if (!S_ISSOCK(path_status.st_mode)){
+                cout << "cannot listen on " << socket_path << ", it is not a socket" << endl;
+                close(listen_fd);
+                return false;
+            }
+            unlink(socket_path.c_str());
+        }
+
+        if (::bind(listen_fd, (sockaddr*)&address, sizeof(address)) != 0 or listen(listen_fd, 64) != 0){
+            cout << "cannot listen on " << socket_path << endl;
+            close(listen_fd);
+            return false;
+        }
+
+        while(true){
+            int connection_fd = accept(listen_fd, nullptr, nullptr);
+            if (connection_fd < 0) continue;
+            thread(&SolverServer::serve_connection, this, connection_fd).detach(); //each client is read on its own thread
+        }
+        return true;
+    }
+};
+
+#endif //SOLVER_SERVER_H
@@ -0,0 +1,124 @@
+// Author: Feiyang Wang fy916
+// The allocation statistics of the VNS bin packing solver: with VNS_BPP_ALLOC_STATS defined (cmake
+// -DVNS_BPP_ALLOC_STATS=ON), the library replaces the global operator new and delete with ones which count the
+// allocations, the bytes and the peak live bytes of each phase of the search, such as the construction, each
+// neighbourhood or the shaking. The phase of a thread is set by VNS_ALLOC_PHASE for the rest of the scope, which
+// otherwise expands to nothing.
+
+#ifndef VNS_ALLOC_STATS_H
+#define VNS_ALLOC_STATS_H
+
+#ifdef VNS_BPP_ALLOC_STATS
+
+#include <atomic>
+#include <mutex>
+#include <cstring>
+#include <cstddef>
+
+
+namespace vns_bpp {
+
+using namespace std;
+
+
+/*
+ * the AllocationCounters hold the counters of each phase. Phase 0 is the code outside all the phases, the others are
+ * added at the first use of their name, whose string must outlive the counters. The counters are plain atomics left
+ * to the zeroed static storage, so the operator new can count the allocations made before main.
+ */
+struct AllocationCounters{
+    static const int max_phases = 32;
+
+    const char* phase_names[max_phases]; //phase 0 has no name, it is reported as "other"
+    atomic<int> phase_nums;
+    mutex names_mutex;
+
+    atomic<long> allocations[max_phases];
+    atomic<long> bytes[max_phases];
+    atomic<long> peak_live_bytes[max_phases]; //the most bytes live at once while the phase allocated
+    atomic<long> live_bytes;
+
+    //the index of the phase with the given name, added if it is new, or 0 once there are too many phases
+    //the names are only added, so the known ones are looked up without the lock
+    int phase_index(const char* name){
+        int known_phases = phase_nums.load(memory_order_acquire);
+        for (int index = 1; index < known_phases; index++){
+            if (strcmp(phase_names[index], name) == 0) return index;
+        }
+        lock_guard<mutex> lock(names_mutex);
+        known_phases = phase_nums.load(memory_order_relaxed);
+        if (known_phases == 0) known_phases = 1;
+        for (int index = 1; index < known_phases; index++){
+            if (strcmp(phase_names[index], name) == 0) return index;
+        }
+        if (known_phases == max_phases) return 0;
+        phase_names[known_phases] = name;
+        phase_nums.store(known_phases + 1, memory_order_release);
+        return known_phases;
+    }
+
+    void record_allocation(int phase, size_t size){
+        allocations[phase].fetch_add(1, memory_order_relaxed);
+        bytes[phase].fetch_add(size, memory_order_relaxed);
+        long live = live_bytes.fetch_add(size, memory_order_relaxed) + size;
+        long peak = peak_live_bytes[phase].load(memory_order_relaxed);
+        while (live > peak and !peak_live_bytes[phase].compare_exchange_weak(peak, live, memory_order_relaxed)){}
+    }
+
+    void record_free(size_t size){
+        live_bytes.fetch_sub(size, memory_order_relaxed);
+    }
+
+    //start counting again, the peaks from the bytes live now
+    void reset(){
+        long live = live_bytes.load(memory_order_relaxed);
+        for (int index = 0; index < max_phases; index++){
+            allocations[index] = 0;
+            bytes[index] = 0;
+            peak_live_bytes[index] = live;
+        }
+    }
+};
+
+inline AllocationCounters& allocation_counters(){
+    static AllocationCounters counters; //its storage is zero before the first allocation, the constructor sets nothing
+    return counters;
+}
+
+inline int& current_allocation_phase(){ //the phase of the calling thread
+    static thread_local int phase;
+    return phase;
+}
+
+
+/*
+ * the AllocationPhase makes the phase the one of the calling thread until the end of its scope
+ */
+class AllocationPhase{
+private:
+    int previous_phase;
+
+public:
+    AllocationPhase(int phase){
+        previous_phase = current_allocation_phase();
+        current_allocation_phase() = phase;
+    }
+    ~AllocationPhase(){
+        current_allocation_phase() = previous_phase;
+    }
+};
+
+} // namespace vns_bpp
+
+#define VNS_ALLOC_CONCAT_(prefix, line) prefix##line
+#define VNS_ALLOC_CONCAT(prefix, line) VNS_ALLOC_CONCAT_(prefix, line)
+//the name may change from call to call, e.g. the name of a neighbourhood, so it is looked up each time
+#define VNS_ALLOC_PHASE(name) vns_bpp::AllocationPhase VNS_ALLOC_CONCAT(allocation_phase_, __LINE__)(vns_bpp::allocation_counters().phase_index(name))
+
+#else
+
+#define VNS_ALLOC_PHASE(name) do {} while (0)
+
+#endif //VNS_BPP_ALLOC_STATS
+
+#endif //VNS_ALLOC_STATS_H
@@ -0,0 +1,184 @@
+// Author: Feiyang Wang fy916
+// The batch engine of the VNS bin packing solver: many small instances are solved one after the other from the
+// contiguous arrays of a SmallBatch, with the work arrays allocated once for the whole batch, so an instance of a few
+// dozen items takes microseconds instead of the setup of a search.
+// This header is internal to the solver library, embedding applications use vns_bpp.h
+
+#ifndef VNS_BATCH_H
+#define VNS_BATCH_H
+
+#include <vector>
+#include <algorithm>
+
+#include "vns_bpp.h"
+#include "vns_exact.h"
+#include "vns_simd.h"
+
+
+namespace vns_bpp {
+
+using namespace std;
+
+
+/*
+ * the SmallBatchSolver packs each instance of the batch by first fit decreasing and best fit decreasing, keeps the
+ * better packing, and if it is above the L2 lower bound looks for a packing in one bin less by bin completion: the
+ * bins are filled one at a time, each opened by the largest item left and closed only when no item left fits in it,
+ * and a branch is cut as soon as the space wasted by its closed bins leaves no room for the items in one bin less.
+ * Unlike the item by item branch and bound of the ExactSolver, this proves the tight instances, such as the
+ * triplets, in a few nodes.
+ */
+class SmallBatchSolver{
+private:
+    long node_limit;
+
+    //the work arrays, as large as the largest instance of the batch
+    vector<long> order; //the item indexes within the instance, from the largest item
+    vector<long> sizes; //the sizes in that order
+    vector<long> ascending_sizes; //and from the smallest, for the lower bound
+    vector<long> prefix_sum;
+    vector<long> residuals; //the remaining size of each open bin of first and best fit
+    vector<char> packed; //the items at each position already in a bin
+    vector<long> bin_of_position; //the bin of the item at each position, in the packing being built
+    vector<long> best_bin_of_position; //in the best packing found
+
+    long item_nums = 0;
+    long capacity = 0;
+    long lower_bound = 0;
+    long best_bins = 0;
+    long open_bins = 0;
+    long allowed_waste = 0; //the space the bins may leave empty in a packing in one bin less than the best
+    long nodes = 0;
+    bool aborted = false;
+
+    //pack the items in order into the first or the best bin they fit in, returns the bins
+    long pack_decreasing(bool best_fit){
+        open_bins = 0;
+        for (long position = 0; position < item_nums; position++){
+            long bin_index = best_fit ? residual_kernels().min_at_least(residuals.data(), open_bins, sizes[position])
+                                      : residual_kernels().first_at_least(residuals.data(), open_bins, sizes[position]);
+            if (bin_index == -1){
+                bin_index = open_bins++;
+                residuals[bin_index] = capacity;
+            }
+            residuals[bin_index] -= sizes[position];
+            bin_of_position[position] = bin_index;
+        }
+        return open_bins;
+    }
+
+    //fill the bin being built with the items from the position on, the largest first, then close it and open the
+    //next one, returns true when the search can stop because a packing was found or the nodes ran out
+    bool fill_bin(long position, long residual, long waste){
+        if (++nodes > node_limit){
+            aborted = true;
+            return true;
+        }
+        while (position < item_nums and (packed[position] or sizes[position] > residual)) position++;
+        if (position < item_nums){
+            //put the item in the bin
+            packed[position] = 1;
+            bin_of_position[position] = open_bins;
+            if (fill_bin(position + 1, residual - sizes[position], waste)) return true;
+            packed[position] = 0;
+            //or leave it out, and the items of the same size after it which would give the same bins
+            long next_position = position + 1;
+            while (next_position < item_nums and sizes[next_position] == sizes[position]) next_position++;
+            return fill_bin(next_position, residual, waste);
+        }
+
+        //only the bins no item left out fits in are closed, every packing can be made of such bins
+        for (long smallest = item_nums - 1; smallest >= 0; smallest--){
+            if (packed[smallest]) continue;
+            if (sizes[smallest] <= residual) return false;
+            break;
+        }
+        if (waste + residual > allowed_waste) return false;
+        open_bins++;
+        bool stop = open_bin(waste + residual);
+        open_bins--;
+        return stop;
+    }
+
+    //open a bin with the largest item left, which has to go into some bin
+    bool open_bin(long waste){
+        long position = 0;
+        while (position < item_nums and packed[position]) position++;
+        if (position == item_nums){ //all the items are packed
+            best_bins = open_bins;
+            copy(bin_of_position.begin(), bin_of_position.begin() + item_nums, best_bin_of_position.begin());
+            return true;
+        }
+        packed[position] = 1;
+        bin_of_position[position] = open_bins;
+        bool stop = fill_bin(position + 1, capacity - sizes[position], waste);
+        packed[position] = 0;
+        return stop;
+    }
+
+public:
+    SmallBatchSolver(long max_items, long max_nodes){
+        node_limit = max_nodes;
+        order.resize(max_items);
+        sizes.resize(max_items);
+        ascending_sizes.resize(max_items);
+        prefix_sum.resize(max_items + 1);
+        residuals.resize(max_items);
+        packed.resize(max_items);
+        bin_of_position.resize(max_items);
+        best_bin_of_position.resize(max_items);
+    }
+
+    //solve the instance with the given sizes, and write the bin of each item to bin_of_item
+    //returns the bins, and sets the lower bound and whether the packing is proven optimal
+    long solve(const long* item_sizes, long instance_item_nums, long bin_capacity, long* bin_of_item, long* instance_lower_bound, bool* is_optimal){
+        item_nums = instance_item_nums;
+        capacity = bin_capacity;
+        for (long item_index = 0; item_index < item_nums; item_index++){
+            order[item_index] = item_index;
+        }
+        sort(order.begin(), order.begin() + item_nums, [item_sizes](long item_a, long item_b){
+            return item_sizes[item_a] > item_sizes[item_b] or (item_sizes[item_a] == item_sizes[item_b] and item_a < item_b);
+        });
+        long total_size = 0;
+        for (long position = 0; position < item_nums; position++){
+            sizes[position] = item_sizes[order[position]];
+            ascending_sizes[item_nums - 1 - position] = sizes[position];
+            total_size += sizes[position];
+        }
+        lower_bound = l2_lower_bound_sorted(ascending_sizes.data(), item_nums, capacity, prefix_sum.data());
+
+        //the better of first fit and best fit decreasing
+        best_bins = pack_decreasing(false);
+        copy(bin_of_position.begin(), bin_of_position.begin() + item_nums, best_bin_of_position.begin());
+        if (best_bins > lower_bound and pack_decreasing(true) < best_bins){
+            best_bins = open_bins;
+            copy(bin_of_position.begin(), bin_of_position.begin() + item_nums, best_bin_of_position.begin());
+        }
+
+        //look for a packing in one bin less until the lower bound is met, the nodes run out, or there is none
+        nodes = 0;
+        aborted = false;
+        while (best_bins > lower_bound){
+            allowed_waste = (best_bins - 1) * capacity - total_size;
+            fill(packed.begin(), packed.begin() + item_nums, 0);
+            open_bins = 0;
+            if (!open_bin(0)){
+                lower_bound = best_bins; //the search was complete, no packing has fewer bins
+                break;
+            }
+            if (aborted) break;
+        }
+
+        for (long position = 0; position < item_nums; position++){
+            bin_of_item[order[position]] = best_bin_of_position[position];
+        }
+        *instance_lower_bound = lower_bound;
+        *is_optimal = best_bins <= lower_bound;
+        return best_bins;
+    }
+};
+
+} // namespace vns_bpp
+
+#endif //VNS_BATCH_H
@@ -0,0 +1,515 @@
+// Author: Feiyang Wang fy916
+// Implementation of the public API of the VNS bin packing solver library
+
+#include "vns_bpp.h"
+#include "vns_solution.h"
+#include "vns_exact.h"
+#include "vns_reduction.h"
+#include "vns_island.h"
+#include "vns_batch.h"
+#include "vns_alloc_stats.h"
+
+#include <thread>
+#include <mutex>
+#include <memory>
+#include <climits>
+#include <set>
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+
+#ifdef VNS_BPP_ALLOC_STATS
+
+//the global operator new and delete of the whole program count the allocations in the phase of the calling thread,
+//each block starts with a header holding its size, 16 bytes so the block keeps the alignment of malloc
+static const size_t allocation_header = 16;
+
+static void* counted_allocate(size_t size){
+    void* block = malloc(size + allocation_header);
+    if (block == nullptr) return nullptr;
+    *(size_t*)block = size;
+    vns_bpp::allocation_counters().record_allocation(vns_bpp::current_allocation_phase(), size);
+    return (char*)block + allocation_header;
+}
+
+static void counted_free(void* pointer){
+    if (pointer == nullptr) return;
+    void* block = (char*)pointer - allocation_header;
+    vns_bpp::allocation_counters().record_free(*(size_t*)block);
+    free(block);
+}
+
+void* operator new(size_t size){
+    void* pointer = counted_allocate(size);
+    if (pointer == nullptr) throw std::bad_alloc();
+    return pointer;
+}
+void* operator new[](size_t size){
+    void* pointer = counted_allocate(size);
+    if (pointer == nullptr) throw std::bad_alloc();
+    return pointer;
+}
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return counted_allocate(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return counted_allocate(size); }
+void operator delete(void* pointer) noexcept { counted_free(pointer); }
+void operator delete[](void* pointer) noexcept { counted_free(pointer); }
+void operator delete(void* pointer, size_t) noexcept { counted_free(pointer); }
+void operator delete[](void* pointer, size_t) noexcept { counted_free(pointer); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept { counted_free(pointer); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept { counted_free(pointer); }
+
+#endif //VNS_BPP_ALLOC_STATS
+
+
+namespace vns_bpp {
+
+//the K-L shapes available to the neighbourhoods
+template struct swap_kernel<1, 0>;
+template struct swap_kernel<1, 1>;
+template struct swap_kernel<1, 2>;
+template struct swap_kernel<2, 1>;
+template struct swap_kernel<2, 2>;
+template struct swap_kernel<2, 3>;
+
+
+//convert the bins of the solution to the assignment of the item indexes
+Assignment to_assignment(const vector<Bin>& bins, long item_nums){
+    Assignment assignment;
+    assignment.bin_of_item.assign(item_nums, -1);
+    for (long bin_index = 0; bin_index < bins.size(); bin_index++){
+        vector<long> items_in_bin;
+        for (auto &item: bins[bin_index].items_in_bin){
+            items_in_bin.push_back(item.get_item_ID());
+            assignment.bin_of_item[item.get_item_ID()] = bin_index;
+        }
+        assignment.bins.push_back(items_in_bin);
+    }
+    return assignment;
+}
+
+
+unsigned long derive_seed(unsigned long seed, const string& stream_name){
+    uint64_t name_hash = 14695981039346656037ULL; //the FNV-1a hash of the name
+    for (unsigned char character: stream_name){
+        name_hash = (name_hash ^ character) * 1099511628211ULL;
+    }
+    return derive_stream_seed(seed, name_hash);
+}
+
+
+long bins_lower_bound(const vector<long>& item_sizes, long capacity){
+    return l2_lower_bound(item_sizes, capacity);
+}
+
+
+bool write_scope_trace(const string& trace_file_name){
+#ifdef VNS_BPP_SCOPE_TRACE
+    return scope_trace_registry().write(trace_file_name);
+#else
+    (void)trace_file_name; //only used by the scope trace builds
+    return false;
+#endif
+}
+
+
+vector<AllocationPhaseStats> allocation_stats(){
+    vector<AllocationPhaseStats> phase_stats;
+#ifdef VNS_BPP_ALLOC_STATS
+    AllocationCounters &counters = allocation_counters();
+    int phase_nums = max(1, counters.phase_nums.load(memory_order_acquire));
+    phase_stats.reserve(phase_nums); //allocated in the phase of the caller, before the counters are read
+    for (int phase = 0; phase < phase_nums; phase++){
+        AllocationPhaseStats stats;
+        stats.phase = phase == 0 ? "other" : counters.phase_names[phase];
+        stats.allocations = counters.allocations[phase].load();
+        stats.bytes = counters.bytes[phase].load();
+        stats.peak_live_bytes = stats.allocations > 0 ? counters.peak_live_bytes[phase].load() : 0;
+        phase_stats.push_back(stats);
+    }
+#endif
+    return phase_stats;
+}
+
+
+void reset_allocation_stats(){
+#ifdef VNS_BPP_ALLOC_STATS
+    allocation_counters().reset();
+#endif
+}
+
+
+long best_fit_decreasing_bins(const vector<long>& item_sizes, long capacity){
+    vector<long> sizes = item_sizes;
+    sort(sizes.rbegin(), sizes.rend());
+    multiset<long> remaining_sizes; //of the open bins
+    for (long size: sizes){
+        auto best_bin = remaining_sizes.lower_bound(size); //the fullest bin the item fits in
+        if (best_bin == remaining_sizes.end()){
+            remaining_sizes.insert(capacity - size);
+        }else{
+            long remaining_size = *best_bin - size;
+            remaining_sizes.erase(best_bin);
+            remaining_sizes.insert(remaining_size);
+        }
+    }
+    return remaining_sizes.size();
+}
+
+
+SmallBatchResult solve_small_batch(const SmallBatch& batch, long exact_node_limit){
+    search_clock::time_point time_start = search_clock::now();
+    long instance_nums = batch.instance_count();
+    SmallBatchResult result;
+    result.bin_of_item.assign(batch.item_sizes.size(), -1);
+    result.bin_counts.assign(instance_nums, 0);
+    result.lower_bounds.assign(instance_nums, 0);
+    result.optimal.assign(instance_nums, 0);
+
+    long max_items = 0;
+    for (long instance_index = 0; instance_index < instance_nums; instance_index++){
+        max_items = max(max_items, batch.item_starts[instance_index + 1] - batch.item_starts[instance_index]);
+    }
+    SmallBatchSolver batch_solver(max_items, exact_node_limit);
+    for (long instance_index = 0; instance_index < instance_nums; instance_index++){
+        long item_start = batch.item_starts[instance_index];
+        bool is_optimal;
+        result.bin_counts[instance_index] = batch_solver.solve(batch.item_sizes.data() + item_start, batch.item_starts[instance_index + 1] - item_start,
+                                                               batch.capacities[instance_index], result.bin_of_item.data() + item_start,
+                                                               &result.lower_bounds[instance_index], &is_optimal);
+        result.optimal[instance_index] = is_optimal;
+    }
+    result.time_spent = seconds_between(time_start, search_clock::now());
+    return result;
+}
+
+
+Assignment SmallBatchResult::get_assignment(const SmallBatch& batch, long instance_index) const {
+    long item_start = batch.item_starts[instance_index];
+    Assignment assignment;
+    assignment.bin_of_item.assign(bin_of_item.begin() + item_start, bin_of_item.begin() + batch.item_starts[instance_index + 1]);
+    assignment.bins.resize(bin_counts[instance_index]);
+    for (long item_index = 0; item_index < assignment.bin_of_item.size(); item_index++){
+        assignment.bins[assignment.bin_of_item[item_index]].push_back(item_index);
+    }
+    assignment.lower_bound = lower_bounds[instance_index];
+    assignment.optimal = optimal[instance_index];
+    assignment.time_spent = batch.instance_count() > 0 ? time_spent / batch.instance_count() : 0;
+    return assignment;
+}
+
+
+//the sum of square of the remaining size of the bins
+template <class Bins>
+long sum_of_squares(const Bins& bins){
+    long sum = 0;
+    for (auto &bin: bins){
+        sum += bin.get_remaining_size() * bin.get_remaining_size();
+    }
+    return sum;
+}
+
+
+//the fixed bins followed by the bins found by the search
+vector<Bin> with_fixed_bins(const vector<Bin>& fixed_bins, const vector<Bin>& searched_bins){
+    vector<Bin> bins = fixed_bins;
+    bins.insert(bins.end(), searched_bins.begin(), searched_bins.end());
+    return bins;
+}
+
+
+//solve the items on their own with the options of a part of a decomposed instance, and return the bins of the items
+vector<Bin> solve_part(const vector<Item>& items, long capacity, const SolverOptions& part_options){
+    vector<long> sizes;
+    for (auto &item: items){
+        sizes.push_back(item.get_item_size());
+    }
+    Assignment assignment = solve(sizes, capacity, part_options);
+    vector<Bin> bins;
+    for (auto &items_in_bin: assignment.bins){
+        Bin bin(capacity);
+        for (long item_index: items_in_bin){
+            bin.add_item_to_bin(items[item_index]);
+        }
+        bins.push_back(bin);
+    }
+    return bins;
+}
+
+
+//the bin of each of the items in the given previous solution, -1 if it has none
+vector<long> part_of_assignment(const vector<Item>& items, const vector<long>& bin_of_item){
+    vector<long> part_bin_of_item;
+    for (auto &item: items){
+        long item_ID = item.get_item_ID();
+        part_bin_of_item.push_back(item_ID < bin_of_item.size() ? bin_of_item[item_ID] : -1);
+    }
+    return part_bin_of_item;
+}
+
+
+//the neighbourhoods do not scale to very large instances, so the items are dealt to groups with the same mix of sizes,
+//the groups are solved in parallel, and then the least filled bins of all groups are searched again together
+vector<Bin> solve_decomposed(const vector<Item>& items, long capacity, const SolverOptions& options, search_clock::time_point time_start,
+                             function<void(const vector<Bin>&, const string&)> report_new_best){
+    long group_nums = max(2L, (long)((items.size() + options.decompose_group_items - 1) / max(1L, options.decompose_group_items)));
+
+    //stratified split: from the largest item, deal the items to the groups forward and then backward
+    vector<Item> sorted_items = items;
+    stable_sort(sorted_items.begin(), sorted_items.end(), [](const Item& item_a, const Item& item_b){
+        return item_a.get_item_size() > item_b.get_item_size();
+    });
+    vector<vector<Item>> groups(group_nums);
+    for (long rank = 0; rank < sorted_items.size(); rank++){
+        long round = rank / group_nums;
+        long group_index = round % 2 == 0 ? rank % group_nums : group_nums - 1 - rank % group_nums;
+        groups[group_index].push_back(sorted_items[rank]);
+    }
+
+    //the groups get three quarters of the time left, shared by the waves of groups run at the same time
+    double time_left = options.max_time - seconds_between(time_start, search_clock::now());
+    long worker_nums = min((long)max(1, options.threads), group_nums);
+    long waves = (group_nums + worker_nums - 1) / worker_nums;
+    mutex message_mutex;
+    SolverOptions part_options = options;
+    part_options.reduce = false; //the reductions have been applied to the whole instance
+    part_options.decompose_min_items = 0;
+    part_options.threads = 1;
+    part_options.best_known_bins = 0;
+    part_options.on_improvement = nullptr;
+    part_options.initial_bin_of_item.clear();
+    part_options.on_message = [&](const string& message){
+        if (!options.on_message) return;
+        lock_guard<mutex> lock(message_mutex);
+        options.on_message(message);
+    };
+
+    vector<vector<Bin>> group_bins(group_nums);
+    atomic<long> next_group(0);
+    auto run_groups = [&](){
+        while(true){
+            long group_index = next_group++;
+            if (group_index >= group_nums) return;
+            SolverOptions group_options = part_options;
+            group_options.max_time = time_left * 0.75 / waves;
+            group_options.seed = derive_stream_seed(options.seed, group_index);
+            if (!options.initial_bin_of_item.empty()){ //each group starts from the previous bins of its items
+                group_options.initial_bin_of_item = part_of_assignment(groups[group_index], options.initial_bin_of_item);
+            }
+            group_bins[group_index] = solve_part(groups[group_index], capacity, group_options);
+        }
+    };
+    vector<thread> workers;
+    for (long worker_index = 0; worker_index < worker_nums; worker_index++){
+        workers.push_back(thread(run_groups));
+    }
+    for (auto &worker: workers){
+        worker.join();
+    }
+
+    //merge the groups
+    vector<Bin> bins;
+    for (auto &each_group: group_bins){
+        bins.insert(bins.end(), each_group.begin(), each_group.end());
+    }
+    report_new_best(bins, "decomposition");
+
+    //the repair searches the least filled bins of all the groups together, as many as one group of items,
+    //starting from their current packing so it can only save bins
+    stable_sort(bins.begin(), bins.end(), [](const Bin& bin_a, const Bin& bin_b){
+        return bin_a.get_remaining_size() > bin_b.get_remaining_size();
+    });
+    SolverOptions repair_options = part_options;
+    vector<Item> boundary_items;
+    long boundary_bins = 0;
+    while (boundary_bins < bins.size() and (boundary_bins < 2 or boundary_items.size() < options.decompose_group_items)){
+        for (auto &item: bins[boundary_bins].items_in_bin){
+            boundary_items.push_back(item);
+            repair_options.initial_bin_of_item.push_back(boundary_bins);
+        }
+        boundary_bins++;
+    }
+    repair_options.max_time = options.max_time - seconds_between(time_start, search_clock::now());
+    vector<Bin> repaired_bins = solve_part(boundary_items, capacity, repair_options);
+    if (repaired_bins.size() < boundary_bins){
+        vector<Bin> repaired_solution = repaired_bins;
+        repaired_solution.insert(repaired_solution.end(), bins.begin() + boundary_bins, bins.end());
+        bins = repaired_solution;
+        report_new_best(bins, "boundary repair");
+    }
+    return bins;
+}
+
+
+Assignment solve(const vector<long>& item_sizes, long capacity, const SolverOptions& options){
+    search_clock::time_point time_start = search_clock::now();
+
+    //the items are identified by their index in the given sizes
+    vector<Item> items;
+    for (long item_index = 0; item_index < item_sizes.size(); item_index++){
+        items.push_back(Item(item_index, item_sizes[item_index]));
+    }
+
+    //the bins fixed by the reduction rules go straight to the solution, only the items left are searched
+    vector<Bin> fixed_bins;
+    if (options.reduce){
+        VNS_TRACE_SCOPE("reduction");
+        VNS_ALLOC_PHASE("reduction");
+        InstanceReducer reducer(capacity);
+        fixed_bins = reducer.reduce(&items);
+    }
+    long fixed_nums = fixed_bins.size();
+    //the fixed bins of the improvement events, which the callback may keep after solve returns
+    shared_ptr<const vector<Bin>> reported_fixed_bins;
+    if (options.on_improvement) reported_fixed_bins = make_shared<const vector<Bin>>(fixed_bins);
+    long item_nums = item_sizes.size();
+    if (items.empty()){ //the reduction has packed all the items, and so optimally
+        Assignment assignment = to_assignment(fixed_bins, item_sizes.size());
+        assignment.lower_bound = fixed_nums;
+        assignment.fixed_bins = fixed_nums;
+        assignment.optimal = true;
+        assignment.time_spent = seconds_between(time_start, search_clock::now());
+        return assignment;
+    }
+
+    //the bounds of the items left, the searches stop when they reach them
+    vector<long> sizes_left;
+    for (auto &item: items){
+        sizes_left.push_back(item.get_item_size());
+    }
+    long lower_bound = l2_lower_bound(sizes_left, capacity);
+    long best_known_bins = max(0L, options.best_known_bins - fixed_nums);
+
+    //very large instances are split into groups solved in parallel
+    if (options.decompose_min_items > 0 and items.size() >= options.decompose_min_items){
+        vector<Bin> bins = solve_decomposed(items, capacity, options, time_start, [&](const vector<Bin>& best_bins, const string& step){
+            if (!options.on_improvement) return;
+            //the decomposition reports only twice, the copy of the bins it makes for the event is not worth avoiding
+            shared_ptr<const vector<Bin>> reported_bins = make_shared<const vector<Bin>>(best_bins);
+            ImprovementEvent event = {seconds_between(time_start, search_clock::now()), fixed_nums + (long)best_bins.size(),
+                                      sum_of_squares(fixed_bins) + sum_of_squares(best_bins), step,
+                                      [reported_fixed_bins, reported_bins, item_nums](){
+                                          return to_assignment(with_fixed_bins(*reported_fixed_bins, *reported_bins), item_nums);
+                                      }};
+            options.on_improvement(event);
+        });
+        Assignment assignment = to_assignment(with_fixed_bins(fixed_bins, bins), item_sizes.size());
+        assignment.lower_bound = fixed_nums + lower_bound;
+        assignment.optimal = assignment.bin_count() <= assignment.lower_bound;
+        assignment.fixed_bins = fixed_nums;
+        assignment.time_spent = seconds_between(time_start, search_clock::now());
+        return assignment;
+    }
+
+    int thread_nums = max(1, options.threads);
+    vector<vector<Bin>> results(thread_nums, vector<Bin>());
+    atomic<bool> stop(false); //set when one of the searches reaches the best known bins
+    mutex report_mutex; //the callbacks are called one at a time
+    long best_reported_bins = LONG_MAX;
+    long best_reported_sum_of_squares = 0;
+    long proven_bins = LONG_MAX; //the bins of a solution the branch and bound has proven optimal during the search
+
+    //in the island mode, the searches form a ring and migration_queues[i] takes the migrants of island i-1 to island i
+    bool islands = options.islands and thread_nums > 1 and options.migration_interval > 0;
+    vector<unique_ptr<MigrationQueue<vector<Bin>>>> migration_queues;
+    for (int thread_index = 0; islands and thread_index < thread_nums; thread_index++){
+        migration_queues.push_back(unique_ptr<MigrationQueue<vector<Bin>>>(new MigrationQueue<vector<Bin>>(2)));
+    }
+
+    auto run_search = [&](int thread_index){
+        Solution solution;
+        solution.set_bin_capacity(capacity);
+        solution.set_best_known_bins(best_known_bins);
+        solution.set_original_items(items);
+        solution.set_initial_assignment(options.initial_bin_of_item);
+        solution.set_lower_bound(lower_bound);
+        solution.set_adaptive_neighbourhoods(options.adaptive_neighbourhoods);
+        solution.set_max_time(options.max_time - seconds_between(time_start, search_clock::now()));
+        solution.set_seed(derive_stream_seed(options.seed, thread_index));
+        solution.set_stop_flag(&stop);
+        solution.set_new_best_callback([&](const PersistentSolution& best_solution, double, const string& neighbourhood){
+            if (!options.on_improvement) return;
+            long best_sum_of_squares = sum_of_squares(best_solution) + sum_of_squares(fixed_bins);
+            long best_bins = best_solution.size() + fixed_nums;
+            lock_guard<mutex> lock(report_mutex);
+            //only report the solutions better than all the ones reported by the searches so far
+            if (best_bins > best_reported_bins) return;
+            if (best_bins == best_reported_bins and best_sum_of_squares <= best_reported_sum_of_squares) return;
+            best_reported_bins = best_bins;
+            best_reported_sum_of_squares = best_sum_of_squares;
+            //the event only copies the handles of the bins, O(bins) instead of O(items), the assignment is built by
+            //the callback if it needs it. The bins the search changes while the snapshot is kept are copied on write
+            shared_ptr<const PersistentSolution> reported_solution = make_shared<const PersistentSolution>(best_solution);
+            ImprovementEvent event = {seconds_between(time_start, search_clock::now()), best_reported_bins, best_sum_of_squares,
+                                      neighbourhood, [reported_fixed_bins, reported_solution, item_nums](){
+                                          return to_assignment(with_fixed_bins(*reported_fixed_bins, reported_solution->to_bins()), item_nums);
+                                      }};
+            options.on_improvement(event);
+        });
+        //when the search is stuck, the branch and bound looks for a solution with one bin less
+        //if it proves there is none, the best solution is optimal and all the searches can stop
+        //small instances try it as soon as the first descent ends, so they finish in milliseconds instead of at the deadline
+        bool small_instance = items.size() <= options.exact_max_items;
+        if (small_instance or (options.stall_rounds > 0 and items.size() <= options.stall_max_items)){
+            solution.set_stall_solver(small_instance ? 0 : options.stall_rounds, [&](const PersistentSolution& best_solution){
+                ExactSolver exact_solver(items, capacity, lower_bound);
+                double exact_time = min(options.exact_max_time, options.max_time - seconds_between(time_start, search_clock::now()));
+                search_clock::time_point exact_deadline = search_clock::now() + chrono::duration_cast<search_clock::duration>(chrono::duration<double>(exact_time));
+                vector<Bin> better_bins;
+                if (exact_solver.solve(best_solution.size(), options.exact_node_limit, exact_deadline, &stop)){
+                    better_bins = exact_solver.get_solution();
+                }
+                if (exact_solver.is_proven()){
+                    lock_guard<mutex> lock(report_mutex);
+                    proven_bins = min(proven_bins, better_bins.empty() ? (long)best_solution.size() : (long)better_bins.size());
+                    stop = true;
+                }
+                return better_bins;
+            });
+        }
+        if (islands){
+            MigrationQueue<vector<Bin>>* outbox = migration_queues[(thread_index + 1) % thread_nums].get();
+            MigrationQueue<vector<Bin>>* inbox = migration_queues[thread_index].get();
+            solution.set_migration(options.migration_interval,
+                                   [outbox](const vector<Bin>& best_bins){ outbox->try_push(best_bins); },
+                                   [inbox](vector<Bin>* migrant){ return inbox->try_pop(migrant); });
+        }
+        solution.set_message_callback([&](const string& message){
+            if (!options.on_message) return;
+            lock_guard<mutex> lock(report_mutex);
+            options.on_message(message);
+        });
+
+        results[thread_index] = solution.varaible_neighbourhood_search();
+        if (results[thread_index].size() <= max(best_known_bins, lower_bound)){
+            stop = true; //the other searches can not do better, stop them
+        }
+    };
+
+    if (thread_nums == 1){
+        run_search(0);
+    }else{
+        vector<thread> threads;
+        for (int thread_index = 0; thread_index < thread_nums; thread_index++){
+            threads.push_back(thread(run_search, thread_index));
+        }
+        for (auto &search_thread: threads){
+            search_thread.join();
+        }
+    }
+
+    //pick the solution with the fewest bins
+    long best_index = 0;
+    for (long thread_index = 1; thread_index < thread_nums; thread_index++){
+        if (results[thread_index].size() < results[best_index].size()) best_index = thread_index;
+    }
+
+    Assignment assignment = to_assignment(with_fixed_bins(fixed_bins, results[best_index]), item_sizes.size());
+    assignment.lower_bound = fixed_nums + (proven_bins == LONG_MAX ? lower_bound : max(lower_bound, proven_bins));
+    assignment.optimal = assignment.bin_count() <= assignment.lower_bound;
+    assignment.fixed_bins = fixed_nums;
+    assignment.time_spent = seconds_between(time_start, search_clock::now());
+    return assignment;
+}
+
+} // namespace vns_bpp
@@ -0,0 +1,148 @@
+// Author: Feiyang Wang fy916
+// Public API of the VNS bin packing solver library
+// The solver takes the item sizes and the bin capacity and returns the assignment of the items to the bins.
+// It does no I/O and keeps no global state, so it can be embedded and called from several threads.
+
+#ifndef VNS_BPP_H
+#define VNS_BPP_H
+
+#include <vector>
+#include <string>
+#include <functional>
+
+
+namespace vns_bpp {
+
+/*
+ * the Assignment is the solution returned by solve, the items are identified by their index in the given sizes
+ */
+struct Assignment{
+    std::vector<std::vector<long>> bins; //the indexes of the items in each bin
+    std::vector<long> bin_of_item; //the bin index of each item
+    double time_spent = 0; //seconds spent by solve
+    long lower_bound = 0; //no solution can have fewer bins
+    bool optimal = false; //the bins are proven to be the fewest possible
+    long fixed_bins = 0; //the bins fixed by the reduction rules before the search
+
+    long bin_count() const {return bins.size();}
+};
+
+
+/*
+ * the ImprovementEvent describes a new best solution found during the search
+ */
+struct ImprovementEvent{
+    double time_spent; //seconds since solve was called
+    long bins; //the number of bins of the new best solution
+    long sum_of_squares; //the sum of square of the remaining size of the bins, larger is better for the same bins
+    std::string neighbourhood; //the neighbourhood which found the solution, or how the first solution was built
+    //builds the new best solution, which takes time in the items, so the search only pays for it when it is called.
+    //It holds a snapshot of the solution, and may be kept and called later from any thread, e.g. only for the latest event
+    std::function<Assignment()> solution;
+};
+
+
+/*
+ * the SolverOptions control one call of solve
+ */
+struct SolverOptions{
+    double max_time = 10; //the deadline of the search, in seconds since solve was called
+    long best_known_bins = 0; //the search stops as soon as a solution with this many bins is found
+    unsigned long seed = 39; //the seed of the random numbers, each search thread derives its own stream from it
+    int threads = 1; //the number of independent searches run in parallel, the best solution is returned
+    std::vector<long> initial_bin_of_item; //warm start: the bin of each item in a previous solution, -1 for new items
+    bool reduce = true; //fix the bins given by the reduction rules of Martello and Toth before the search
+    long decompose_min_items = 2000; //instances with at least this many items are split into groups solved in parallel, 0 never
+    long decompose_group_items = 500; //the items of each group, and of the least filled bins searched again after the merge
+    int exact_max_items = 300; //instances with at most this many items try the branch and bound as soon as the first descent ends
+    long exact_node_limit = 1000000; //the nodes of each branch and bound run
+    double exact_max_time = 1; //the seconds of each branch and bound run
+    bool adaptive_neighbourhoods = true; //order the neighbourhoods by their improvements per CPU second, instead of a fixed order
+    long stall_rounds = 100; //the shakings without saving a bin after which the branch and bound tries to, 0 never
+    long stall_max_items = 10000; //the branch and bound recurses once per item, so larger instances never try it
+    bool islands = false; //the threads exchange their best solutions in a ring and cross them with their own, instead of searching alone
+    double migration_interval = 0.5; //the seconds between two exchanges of the islands
+    std::function<void(const ImprovementEvent&)> on_improvement; //called at every new best solution of all the searches
+    std::function<void(const std::string&)> on_message; //called with the diagnostic messages of the search
+};
+
+
+/*
+ * the SmallBatch holds many small instances one after the other in contiguous arrays, to be solved together by
+ * solve_small_batch without setting up a search for each of them
+ */
+struct SmallBatch{
+    std::vector<long> capacities; //the bin capacity of each instance
+    std::vector<long> item_starts = {0}; //the items of instance i are item_starts[i] to item_starts[i+1]-1
+    std::vector<long> item_sizes; //the sizes of the items of all the instances
+
+    void add_instance(const std::vector<long>& sizes, long capacity){
+        capacities.push_back(capacity);
+        item_sizes.insert(item_sizes.end(), sizes.begin(), sizes.end());
+        item_starts.push_back(item_sizes.size());
+    }
+    long instance_count() const {return capacities.size();}
+};
+
+
+/*
+ * the SmallBatchResult is the solution of each instance of a SmallBatch
+ */
+struct SmallBatchResult{
+    std::vector<long> bin_of_item; //the bin of each item within its instance, in the layout of the item sizes of the batch
+    std::vector<long> bin_counts; //the bins of each instance
+    std::vector<long> lower_bounds; //no solution of the instance can have fewer bins
+    std::vector<char> optimal; //the bins of the instance are proven to be the fewest possible
+    double time_spent = 0; //seconds spent by solve_small_batch on the whole batch
+
+    //the solution of one instance, its items identified by their index within the instance
+    Assignment get_assignment(const SmallBatch& batch, long instance_index) const;
+};
+
+
+/*
+ * the AllocationPhaseStats are the allocations made during one phase of the solver, see allocation_stats
+ */
+struct AllocationPhaseStats{
+    std::string phase; //e.g. "minimum bin slack", a neighbourhood such as "1-0 move", or "other" outside all phases
+    long allocations = 0; //the calls to operator new
+    long bytes = 0; //the bytes they asked for
+    long peak_live_bytes = 0; //the most bytes live at once, in all the threads, when the phase allocated
+};
+
+
+//the seed of a named stream of the given seed, e.g. one per instance ID so each instance gets the same
+//random numbers however the instances are ordered or spread over processes
+unsigned long derive_seed(unsigned long seed, const std::string& stream_name);
+
+//the L2 lower bound of Martello and Toth on the bins of the items with the given sizes and bin capacity
+long bins_lower_bound(const std::vector<long>& item_sizes, long capacity);
+
+//the bins of the best fit decreasing packing of the items, a quick upper bound which with the lower bound tells
+//how far from optimal a first solution may be
+long best_fit_decreasing_bins(const std::vector<long>& item_sizes, long capacity);
+
+//write the scopes recorded so far as a Chrome trace, returns false if the library is built without
+//VNS_BPP_SCOPE_TRACE or the file can not be written
+bool write_scope_trace(const std::string& trace_file_name);
+
+//the allocations made by each phase since the start or the last reset_allocation_stats, from all the threads,
+//empty if the library is built without VNS_BPP_ALLOC_STATS
+std::vector<AllocationPhaseStats> allocation_stats();
+
+//count the allocations from zero again, and the peaks from the bytes live now
+void reset_allocation_stats();
+
+//solve the small instances of the batch, e.g. below 50 items each, one after the other on the calling thread:
+//each is packed by first fit decreasing and best fit decreasing, and if neither meets the L2 lower bound the
+//branch and bound tries to close the gap within exact_node_limit nodes. There is no VNS and no deadline, the
+//node limit bounds the time of each instance
+SmallBatchResult solve_small_batch(const SmallBatch& batch, long exact_node_limit = 1000);
+
+//solve the bin packing problem of the items with the given sizes and bin capacity
+//the options.on_improvement and options.on_message callbacks may be called from the search threads, one at a time
+Assignment solve(const std::vector<long>& item_sizes, long capacity, const SolverOptions& options);
+
+} // namespace vns_bpp
+
+#endif //VNS_BPP_H
@@ -0,0 +1,202 @@
+// Author: Feiyang Wang fy916
+// The exact engine of the VNS bin packing solver: the L2 lower bound of Martello and Toth, and a branch and bound
+// which proves small instances optimal, or finds a solution with one bin less when the VNS is stuck.
+// This header is internal to the solver library, embedding applications use vns_bpp.h
+
+#ifndef VNS_EXACT_H
+#define VNS_EXACT_H
+
+#include <vector>
+#include <algorithm>
+#include <atomic>
+
+#include "vns_solution.h"
+
+
+namespace vns_bpp {
+
+using namespace std;
+
+
+//the L2 lower bound of Martello and Toth: for each alpha up to half the capacity, the items larger than capacity - alpha
+//and the items larger than half the capacity need a bin each, and the items between alpha and half the capacity
+//fill what is left in the bins of the second group before they need new bins
+//the sizes are sorted from the smallest, and prefix_sum has room for item_nums + 1 numbers, so the batch engine
+//can compute it without allocating
+inline long l2_lower_bound_sorted(const long* sizes, long item_nums, long capacity, long* prefix_sum){
+    if (item_nums == 0 or capacity <= 0) return 0;
+    prefix_sum[0] = 0; //the total size of the smallest items
+    for (long item_index = 0; item_index < item_nums; item_index++){
+        prefix_sum[item_index + 1] = prefix_sum[item_index] + sizes[item_index];
+    }
+    //the first item with a size larger than the given one
+    auto first_larger = [&](long size){ return (long)(std::upper_bound(sizes, sizes + item_nums, size) - sizes); };
+    //the first item with a size not smaller than the given one
+    auto first_not_smaller = [&](long size){ return (long)(std::lower_bound(sizes, sizes + item_nums, size) - sizes); };
+
+    long half_start = first_larger(capacity / 2); //the items from here are larger than half the capacity
+    long best_bound = (prefix_sum[item_nums] + capacity - 1) / capacity; //the continuous bound L1
+
+    long previous_alpha = -1;
+    for (long alpha_index = -1; alpha_index < half_start; alpha_index++){
+        long alpha = alpha_index < 0 ? 0 : sizes[alpha_index];
+        if (alpha == previous_alpha) continue;
+        previous_alpha = alpha;
+
+        long large_start = first_larger(capacity - alpha); //J1: the items which fit with no item of J3
+        long small_start = first_not_smaller(alpha); //J3: the items from alpha to half the capacity
+        long medium_nums = large_start - half_start; //J2
+        long medium_free = medium_nums * capacity - (prefix_sum[large_start] - prefix_sum[half_start]);
+        long small_size = prefix_sum[half_start] - prefix_sum[small_start];
+
+        long bound = (item_nums - half_start);
+        if (small_size > medium_free) bound += (small_size - medium_free + capacity - 1) / capacity;
+        best_bound = max(best_bound, bound);
+    }
+    return best_bound;
+}
+
+inline long l2_lower_bound(vector<long> sizes, long capacity){
+    sort(sizes.begin(), sizes.end());
+    vector<long> prefix_sum(sizes.size() + 1);
+    return l2_lower_bound_sorted(sizes.data(), sizes.size(), capacity, prefix_sum.data());
+}
+
+
+/*
+ * the ExactSolver is a depth first branch and bound in the style of Martello and Toth: the items are packed from the
+ * largest, each one into one of the open bins or a new bin. Bins with the same remaining size are only tried once,
+ * an item which fills a bin exactly only goes there, and a node is cut when its bins plus the size left over the free
+ * space of the open bins can not beat the best solution. It stops at a node limit or a deadline.
+ */
+class ExactSolver{
+private:
+    vector<Item> items; //sorted from the largest
+    vector<long> size_after; //the total size of the items after each position
+    long bin_capacity;
+    long lower_bound;
+
+    vector<long> remaining_sizes; //the remaining size of each open bin
+    vector<long> bin_of_item; //the bin of each item in the current node
+    long free_size = 0; //the total remaining size of the open bins
+
+    long best_bins;
+    vector<long> best_bin_of_item; //empty until a solution better than the upper bound is found
+
+    long nodes = 0;
+    long node_limit;
+    search_clock::time_point deadline;
+    const atomic<bool>* stop_flag;
+    bool aborted = false;
+
+    bool out_of_budget(){
+        nodes++;
+        if (nodes > node_limit) aborted = true;
+        if ((nodes & 1023) == 0 and (search_clock::now() >= deadline or (stop_flag != nullptr and stop_flag->load()))) aborted = true;
+        return aborted;
+    }
+
+    //pack the items from item_index on, returns true when the search can stop because the lower bound is reached
+    bool branch(long item_index){
+        if (out_of_budget()) return true;
+        long open_bins = remaining_sizes.size();
+        if (item_index == items.size()){
+            best_bins = open_bins;
+            best_bin_of_item = bin_of_item;
+            return best_bins <= lower_bound;
+        }
+
+        //the bins needed by the items left if they could be split over the free space of the open bins
+        long overflow = size_after[item_index] - free_size;
+        long bound = open_bins + (overflow > 0 ? (overflow + bin_capacity - 1) / bin_capacity : 0);
+        if (bound >= best_bins) return false;
+
+        long item_size = items[item_index].get_item_size();
+
+        //an item which fills a bin exactly is always best put there
+        for (long bin_index = 0; bin_index < open_bins; bin_index++){
+            if (remaining_sizes[bin_index] == item_size){
+                return place_and_branch(item_index, bin_index);
+            }
+        }
+
+        for (long bin_index = 0; bin_index < open_bins; bin_index++){
+            long remaining_size = remaining_sizes[bin_index];
+            if (remaining_size < item_size) continue;
+            //bins with the same remaining size give the same subtrees, so only the first of them is tried, found
+            //among the earlier bins instead of a list of the sizes tried, which would be allocated at every node
+            if (find(remaining_sizes.begin(), remaining_sizes.begin() + bin_index, remaining_size) != remaining_sizes.begin() + bin_index) continue;
+            if (place_and_branch(item_index, bin_index)) return true;
+            if (open_bins + (overflow > 0 ? (overflow + bin_capacity - 1) / bin_capacity : 0) >= best_bins) return false;
+        }
+
+        //open a new bin only if that can still beat the best solution
+        if (open_bins + 1 < best_bins){
+            remaining_sizes.push_back(bin_capacity);
+            free_size += bin_capacity;
+            bool stop = place_and_branch(item_index, open_bins);
+            free_size -= bin_capacity;
+            remaining_sizes.pop_back();
+            if (stop) return true;
+        }
+        return false;
+    }
+
+    bool place_and_branch(long item_index, long bin_index){
+        long item_size = items[item_index].get_item_size();
+        remaining_sizes[bin_index] -= item_size;
+        free_size -= item_size;
+        bin_of_item[item_index] = bin_index;
+        bool stop = branch(item_index + 1);
+        remaining_sizes[bin_index] += item_size;
+        free_size += item_size;
+        return stop;
+    }
+
+public:
+    ExactSolver(const vector<Item>& given_items, long capacity, long lower_bound_bins){
+        items = given_items;
+        stable_sort(items.begin(), items.end(), [](const Item& item_a, const Item& item_b){
+            return item_a.get_item_size() > item_b.get_item_size();
+        });
+        size_after.assign(items.size() + 1, 0);
+        for (long item_index = items.size() - 1; item_index >= 0; item_index--){
+            size_after[item_index] = size_after[item_index + 1] + items[item_index].get_item_size();
+        }
+        bin_capacity = capacity;
+        lower_bound = lower_bound_bins;
+        remaining_sizes.reserve(items.size()); //at most a bin per item, so the search never reallocates it
+    }
+
+    //search for a solution with fewer bins than upper_bound, returns true if one is found
+    //the search is complete, and so the best solution found is optimal, if is_proven is true afterwards
+    bool solve(long upper_bound, long max_nodes, search_clock::time_point search_deadline, const atomic<bool>* stop){
+        best_bins = upper_bound;
+        best_bin_of_item.clear();
+        remaining_sizes.clear();
+        bin_of_item.assign(items.size(), -1);
+        free_size = 0;
+        nodes = 0;
+        node_limit = max_nodes;
+        deadline = search_deadline;
+        stop_flag = stop;
+        aborted = false;
+        if (upper_bound > lower_bound) branch(0);
+        return !best_bin_of_item.empty();
+    }
+
+    bool is_proven(){ return !aborted or best_bins <= lower_bound; }
+    long get_nodes(){ return nodes; }
+
+    vector<Bin> get_solution(){ //the bins of the best solution found
+        vector<Bin> bins(best_bins, Bin(bin_capacity));
+        for (long item_index = 0; item_index < items.size(); item_index++){
+            bins[best_bin_of_item[item_index]].add_item_to_bin(items[item_index]);
+        }
+        return bins;
+    }
+};
+
+} // namespace vns_bpp
+
+#endif //VNS_EXACT_H
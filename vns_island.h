@@ -0,0 +1,56 @@
+// Author: Feiyang Wang fy916
+// The island mode of the VNS bin packing solver: the parallel searches are islands in a ring, each one sends its
+// best solution to the next island from time to time and crosses the solution it receives with its own.
+// This header is internal to the solver library, embedding applications use vns_bpp.h
+
+#ifndef VNS_ISLAND_H
+#define VNS_ISLAND_H
+
+#include <vector>
+#include <atomic>
+#include <utility>
+
+
+namespace vns_bpp {
+
+using namespace std;
+
+
+/*
+ * the MigrationQueue is a lock-free ring buffer between one producer island and one consumer island.
+ * Only the producer moves the tail and only the consumer moves the head, so pushing and popping never wait:
+ * a migrant which does not fit is dropped, the next island will get a newer one.
+ */
+template <class T>
+class MigrationQueue{
+private:
+    vector<T> slots; //one more slot than the capacity, so a full queue can be told from an empty one
+    atomic<long> head{0}; //the next slot to pop, moved by the consumer
+    atomic<long> tail{0}; //the next slot to push, moved by the producer
+
+public:
+    MigrationQueue(long capacity){
+        slots.resize(capacity + 1);
+    }
+
+    bool try_push(T value){ //called by the producer only, returns false if the queue is full
+        long current_tail = tail.load(memory_order_relaxed);
+        long next_tail = (current_tail + 1) % (long)slots.size();
+        if (next_tail == head.load(memory_order_acquire)) return false;
+        slots[current_tail] = move(value);
+        tail.store(next_tail, memory_order_release); //the slot is written before the consumer can see it
+        return true;
+    }
+
+    bool try_pop(T* value){ //called by the consumer only, returns false if the queue is empty
+        long current_head = head.load(memory_order_relaxed);
+        if (current_head == tail.load(memory_order_acquire)) return false;
+        *value = move(slots[current_head]);
+        head.store((current_head + 1) % (long)slots.size(), memory_order_release); //the slot can be written again
+        return true;
+    }
+};
+
+} // namespace vns_bpp
+
+#endif //VNS_ISLAND_H
@@ -0,0 +1,147 @@
+// Author: Feiyang Wang fy916
+// The preprocessing of the VNS bin packing solver: the reduction rules of Martello and Toth fix the bins which some
+// optimal solution is known to contain, so only the items left are given to the search.
+// This header is internal to the solver library, embedding applications use vns_bpp.h
+
+#ifndef VNS_REDUCTION_H
+#define VNS_REDUCTION_H
+
+#include <vector>
+#include <set>
+#include <iterator>
+#include <utility>
+#include <climits>
+
+#include "vns_solution.h"
+
+
+namespace vns_bpp {
+
+using namespace std;
+
+
+/*
+ * the InstanceReducer applies the dominance rules of Martello and Toth to the items from the largest.
+ * For each item j not fixed yet, with the room left by j in a bin, the bin of j is fixed as:
+ *   {j}        if no other item fits with j;
+ *   {j, k}     if k fills the room exactly, or if no two items fit with j and k is the largest one which fits;
+ *   {j, x, y}  if x is the largest item which fits, y fills the rest exactly, no three items fit with j, and no two
+ *              items between y and x fit together, so any two items fitting with j can be swapped with x and y.
+ * Each of these bins dominates every other bin containing j, so some optimal solution contains it.
+ */
+class InstanceReducer{
+private:
+    long bin_capacity;
+    multiset<pair<long, long>> free_items; //the size and the position of the items not fixed yet
+
+    //the largest free item not larger than the given size, or end
+    multiset<pair<long, long>>::iterator largest_fitting(long size){
+        auto next_larger = free_items.upper_bound(make_pair(size, LONG_MAX));
+        if (next_larger == free_items.begin()) return free_items.end();
+        return prev(next_larger);
+    }
+
+    //the total size of the smallest count free items, or more than any room if there are fewer items
+    long smallest_total(long count){
+        long total = 0;
+        auto it = free_items.begin();
+        for (long counter = 0; counter < count; counter++, it++){
+            if (it == free_items.end()) return LONG_MAX / 2;
+            total += it->first;
+        }
+        return total;
+    }
+
+    //check the rules for the item, and return the positions of the other items of its fixed bin, or false
+    bool find_dominant_bin(long item_size, vector<long>* partners){
+        long room = bin_capacity - item_size;
+        partners->clear();
+
+        //alone: nothing fits with the item
+        if (free_items.empty() or free_items.begin()->first > room) return true;
+
+        //exact pair
+        auto exact = free_items.lower_bound(make_pair(room, LONG_MIN));
+        if (exact != free_items.end() and exact->first == room){
+            partners->push_back(exact->second);
+            return true;
+        }
+
+        auto largest = largest_fitting(room);
+
+        //at most one item fits with the item, the largest one is the best
+        if (smallest_total(2) > room){
+            partners->push_back(largest->second);
+            return true;
+        }
+
+        //exact triplet with the largest fitting item
+        if (smallest_total(3) <= room) return false;
+        long rest = room - largest->first;
+        auto filler = free_items.lower_bound(make_pair(rest, LONG_MIN));
+        if (filler == largest) filler++; //the same item can not be used twice
+        if (filler == free_items.end() or filler->first != rest) return false;
+
+        //two items strictly between the sizes of the filler and the largest could fit together in a way
+        //that can not be split over the bins of the largest and the filler
+        auto between = free_items.upper_bound(make_pair(rest, LONG_MAX));
+        if (between != free_items.end() and between->first < largest->first){
+            auto second = next(between);
+            if (second != free_items.end() and second->first < largest->first and between->first + second->first <= room){
+                return false;
+            }
+        }
+        partners->push_back(largest->second);
+        partners->push_back(filler->second);
+        return true;
+    }
+
+public:
+    InstanceReducer(long capacity){
+        bin_capacity = capacity;
+    }
+
+    //remove the items of the fixed bins from the items, and return the fixed bins
+    vector<Bin> reduce(vector<Item>* items){
+        free_items.clear();
+        for (long item_index = 0; item_index < items->size(); item_index++){
+            free_items.insert(make_pair(items->at(item_index).get_item_size(), item_index));
+        }
+
+        vector<bool> is_fixed(items->size(), false);
+        vector<Bin> fixed_bins;
+        vector<long> partners;
+
+        //go through the items from the largest, the items no rule applies to stay free for the later items
+        vector<pair<long, long>> largest_first(free_items.rbegin(), free_items.rend());
+        for (auto &current_item: largest_first){
+            if (is_fixed[current_item.second]) continue;
+            free_items.erase(free_items.find(current_item));
+            if (!find_dominant_bin(current_item.first, &partners)){
+                free_items.insert(current_item);
+                continue;
+            }
+
+            Bin fixed_bin(bin_capacity);
+            fixed_bin.add_item_to_bin(items->at(current_item.second));
+            is_fixed[current_item.second] = true;
+            for (long partner_index: partners){
+                fixed_bin.add_item_to_bin(items->at(partner_index));
+                is_fixed[partner_index] = true;
+                free_items.erase(free_items.find(make_pair(items->at(partner_index).get_item_size(), partner_index)));
+            }
+            fixed_bins.push_back(fixed_bin);
+        }
+
+        vector<Item> items_left;
+        for (long item_index = 0; item_index < items->size(); item_index++){
+            if (!is_fixed[item_index]) items_left.push_back(items->at(item_index));
+        }
+        *items = items_left;
+        return fixed_bins;
+    }
+};
+
+} // namespace vns_bpp
+
+#endif //VNS_REDUCTION_H
@@ -0,0 +1,192 @@
+// Author: Feiyang Wang fy916
+// The scope tracing of the VNS bin packing solver: the time spent in the hot scopes of the search and of the file
+// I/O is recorded per thread and written as a Chrome trace, to be opened in chrome://tracing or ui.perfetto.dev.
+// It is compiled out unless VNS_BPP_SCOPE_TRACE is defined (cmake -DVNS_BPP_SCOPE_TRACE=ON), and then
+// VNS_TRACE_SCOPE expands to nothing.
+
+#ifndef VNS_SCOPE_TRACE_H
+#define VNS_SCOPE_TRACE_H
+
+#ifdef VNS_BPP_SCOPE_TRACE
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <chrono>
+#include <fstream>
+#include <cstdint>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+
+namespace vns_bpp {
+
+using namespace std;
+
+
+//the time stamp counter of the core, or the steady clock in nanoseconds where there is none
+inline uint64_t trace_ticks(){
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+
+/*
+ * the ThreadTraceBuffer is the ring buffer of the scopes closed by one thread, only that thread writes it.
+ * When it is full the oldest scopes are overwritten, so a long run keeps its last scopes.
+ */
+struct ThreadTraceBuffer{
+    struct TraceEvent{
+        const char* name;
+        uint64_t start_ticks;
+        uint64_t end_ticks;
+    };
+
+    long thread_number;
+    vector<TraceEvent> events;
+    uint64_t events_written = 0;
+
+    ThreadTraceBuffer(long number, long capacity){
+        thread_number = number;
+        events.resize(capacity);
+    }
+
+    void record(const char* name, uint64_t start_ticks, uint64_t end_ticks){
+        TraceEvent &event = events[events_written % events.size()];
+        event.name = name;
+        event.start_ticks = start_ticks;
+        event.end_ticks = end_ticks;
+        events_written++;
+    }
+};
+
+
+/*
+ * the ScopeTraceRegistry owns the buffers of all the threads, so they outlive the threads, and converts the ticks
+ * to microseconds with the rate measured between its creation and the writing of the trace.
+ * The buffer of a finished thread is handed to the next new thread, so there are only as many buffers as threads
+ * running at once, however many the searches start. Its scopes are kept until the new thread overwrites them, and
+ * both threads are written under the same tid.
+ */
+class ScopeTraceRegistry{
+private:
+    vector<unique_ptr<ThreadTraceBuffer>> buffers;
+    vector<ThreadTraceBuffer*> free_buffers; //the buffers of the finished threads
+    mutex buffers_mutex; //taken when a thread records its first scope, and when the trace is written
+    uint64_t start_ticks;
+    chrono::steady_clock::time_point start_time;
+
+public:
+    long buffer_events = 1 << 16; //the scopes kept per thread
+
+    ScopeTraceRegistry(){
+        start_ticks = trace_ticks();
+        start_time = chrono::steady_clock::now();
+    }
+
+    ThreadTraceBuffer* add_thread(){
+        lock_guard<mutex> lock(buffers_mutex);
+        if (!free_buffers.empty()){
+            ThreadTraceBuffer* buffer = free_buffers.back();
+            free_buffers.pop_back();
+            return buffer;
+        }
+        buffers.push_back(unique_ptr<ThreadTraceBuffer>(new ThreadTraceBuffer(buffers.size(), buffer_events)));
+        return buffers.back().get();
+    }
+
+    void release_thread(ThreadTraceBuffer* buffer){ //called when the thread of the buffer ends
+        lock_guard<mutex> lock(buffers_mutex);
+        free_buffers.push_back(buffer);
+    }
+
+    //write the scopes as complete events of the Chrome trace format, should be called once the searches are done
+    bool write(const string& trace_file_name){
+        lock_guard<mutex> lock(buffers_mutex);
+        double elapsed_us = chrono::duration<double, micro>(chrono::steady_clock::now() - start_time).count();
+        double ticks_per_us = elapsed_us > 0 ? (trace_ticks() - start_ticks) / elapsed_us : 1;
+        if (ticks_per_us <= 0) ticks_per_us = 1;
+
+        ofstream trace_stream(trace_file_name, ios::out | ios::trunc);
+        if (!trace_stream.is_open()) return false;
+        trace_stream << "{\"traceEvents\":[";
+        bool first_event = true;
+        for (auto &buffer: buffers){
+            uint64_t capacity = buffer->events.size();
+            uint64_t first = buffer->events_written > capacity ? buffer->events_written - capacity : 0;
+            for (uint64_t event_index = first; event_index < buffer->events_written; event_index++){
+                const ThreadTraceBuffer::TraceEvent &event = buffer->events[event_index % capacity];
+                trace_stream << (first_event ? "\n" : ",\n");
+                trace_stream << "{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->thread_number
+                             << ",\"ts\":" << (double)(int64_t)(event.start_ticks - start_ticks) / ticks_per_us
+                             << ",\"dur\":" << (double)(event.end_ticks - event.start_ticks) / ticks_per_us << "}";
+                first_event = false;
+            }
+        }
+        trace_stream << "\n],\"displayTimeUnit\":\"ms\"}" << endl;
+        return (bool)trace_stream;
+    }
+};
+
+inline ScopeTraceRegistry& scope_trace_registry(){
+    static ScopeTraceRegistry registry;
+    return registry;
+}
+
+/*
+ * the ThreadTraceOwner holds the buffer of one thread, and gives it back to the registry when the thread ends
+ */
+class ThreadTraceOwner{
+public:
+    ThreadTraceBuffer* buffer;
+
+    ThreadTraceOwner(){
+        buffer = scope_trace_registry().add_thread();
+    }
+    ~ThreadTraceOwner(){ //the registry is created before the first owner, so it is still there
+        scope_trace_registry().release_thread(buffer);
+    }
+};
+
+inline ThreadTraceBuffer* thread_trace_buffer(){ //the buffer of the calling thread, taken at its first scope
+    thread_local ThreadTraceOwner owner;
+    return owner.buffer;
+}
+
+
+/*
+ * the TraceScope records the time from its creation to the end of its scope
+ */
+class TraceScope{
+private:
+    const char* scope_name; //must outlive the trace, string literals or static names
+    uint64_t start_ticks;
+
+public:
+    TraceScope(const char* name){
+        scope_name = name;
+        start_ticks = trace_ticks();
+    }
+    ~TraceScope(){
+        thread_trace_buffer()->record(scope_name, start_ticks, trace_ticks());
+    }
+};
+
+} // namespace vns_bpp
+
+#define VNS_TRACE_CONCAT_(prefix, line) prefix##line
+#define VNS_TRACE_CONCAT(prefix, line) VNS_TRACE_CONCAT_(prefix, line)
+#define VNS_TRACE_SCOPE(name) vns_bpp::TraceScope VNS_TRACE_CONCAT(trace_scope_, __LINE__)(name)
+
+#else
+
+#define VNS_TRACE_SCOPE(name) do {} while (0)
+
+#endif //VNS_BPP_SCOPE_TRACE
+
+#endif //VNS_SCOPE_TRACE_H
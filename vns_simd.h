@@ -0,0 +1,220 @@
+// Author: Feiyang Wang fy916
+// The residual scan kernels of the VNS bin packing solver: the scans over the remaining sizes of the bins used by
+// best fit, by the 1-0 move and by the 1-1-1 swap, on AVX2 or SSE4.2 when the processor has them.
+// This header is internal to the solver library, embedding applications use vns_bpp.h
+
+#ifndef VNS_SIMD_H
+#define VNS_SIMD_H
+
+#include <climits>
+#include <algorithm>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__) && defined(__LP64__)
+#define VNS_BPP_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+
+namespace vns_bpp {
+
+using namespace std;
+
+
+//the scalar kernels, used where there is no vector unit and for the tails of the vector kernels
+
+//the index of the first residual at least the size, or -1
+inline long first_at_least_scalar(const long* residuals, long residual_nums, long size){
+    for (long index = 0; index < residual_nums; index++){
+        if (residuals[index] >= size) return index;
+    }
+    return -1;
+}
+
+//the index of the first of the smallest residuals at least the size, or -1, which is the bin best fit picks
+inline long min_at_least_scalar(const long* residuals, long residual_nums, long size){
+    long best_index = -1;
+    for (long index = 0; index < residual_nums; index++){
+        if (residuals[index] >= size and (best_index == -1 or residuals[index] < residuals[best_index])) best_index = index;
+    }
+    return best_index;
+}
+
+//write the indexes of the residuals in [low, high] to the given array, and return how many there are
+inline long filter_between_scalar(const long* residuals, long residual_nums, long low, long high, long* indexes){
+    long found_nums = 0;
+    for (long index = 0; index < residual_nums; index++){
+        if (residuals[index] >= low and residuals[index] <= high) indexes[found_nums++] = index;
+    }
+    return found_nums;
+}
+
+
+#ifdef VNS_BPP_X86_KERNELS
+
+//the residuals are longs, so an AVX2 register holds four of them and an SSE register two: the 64 bit compare
+//instructions are AVX2 and SSE4.2, the masks come out with movemask_pd, one bit per residual
+
+__attribute__((target("avx2")))
+inline long first_at_least_avx2(const long* residuals, long residual_nums, long size){
+    __m256i below = _mm256_set1_epi64x(size - 1);
+    long index = 0;
+    for (; index + 4 <= residual_nums; index += 4){
+        __m256i values = _mm256_loadu_si256((const __m256i*)(residuals + index));
+        int mask = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(values, below)));
+        if (mask != 0) return index + __builtin_ctz(mask);
+    }
+    long tail = first_at_least_scalar(residuals + index, residual_nums - index, size);
+    return tail == -1 ? -1 : index + tail;
+}
+
+__attribute__((target("avx2")))
+inline long min_at_least_avx2(const long* residuals, long residual_nums, long size){
+    __m256i below = _mm256_set1_epi64x(size - 1);
+    __m256i none = _mm256_set1_epi64x(LONG_MAX);
+    __m256i smallest = none;
+    long index = 0;
+    for (; index + 4 <= residual_nums; index += 4){
+        __m256i values = _mm256_loadu_si256((const __m256i*)(residuals + index));
+        __m256i fitting = _mm256_blendv_epi8(none, values, _mm256_cmpgt_epi64(values, below));
+        smallest = _mm256_blendv_epi8(smallest, fitting, _mm256_cmpgt_epi64(smallest, fitting));
+    }
+    long lanes[4];
+    _mm256_storeu_si256((__m256i*)lanes, smallest);
+    long smallest_value = LONG_MAX;
+    for (long lane: lanes) smallest_value = min(smallest_value, lane);
+    for (long tail = index; tail < residual_nums; tail++){
+        if (residuals[tail] >= size) smallest_value = min(smallest_value, residuals[tail]);
+    }
+    if (smallest_value == LONG_MAX) return -1;
+
+    //the first residual equal to the smallest one
+    __m256i target = _mm256_set1_epi64x(smallest_value);
+    for (index = 0; index + 4 <= residual_nums; index += 4){
+        __m256i values = _mm256_loadu_si256((const __m256i*)(residuals + index));
+        int mask = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(values, target)));
+        if (mask != 0) return index + __builtin_ctz(mask);
+    }
+    for (; index < residual_nums; index++){
+        if (residuals[index] == smallest_value) return index;
+    }
+    return -1;
+}
+
+__attribute__((target("avx2")))
+inline long filter_between_avx2(const long* residuals, long residual_nums, long low, long high, long* indexes){
+    __m256i below = _mm256_set1_epi64x(low - 1);
+    __m256i above = _mm256_set1_epi64x(high);
+    long found_nums = 0;
+    long index = 0;
+    for (; index + 4 <= residual_nums; index += 4){
+        __m256i values = _mm256_loadu_si256((const __m256i*)(residuals + index));
+        __m256i inside = _mm256_andnot_si256(_mm256_cmpgt_epi64(values, above), _mm256_cmpgt_epi64(values, below));
+        int mask = _mm256_movemask_pd(_mm256_castsi256_pd(inside));
+        while (mask != 0){
+            indexes[found_nums++] = index + __builtin_ctz(mask);
+            mask &= mask - 1;
+        }
+    }
+    long tail_nums = filter_between_scalar(residuals + index, residual_nums - index, low, high, indexes + found_nums);
+    for (long tail = found_nums; tail < found_nums + tail_nums; tail++){
+        indexes[tail] += index;
+    }
+    return found_nums + tail_nums;
+}
+
+__attribute__((target("sse4.2")))
+inline long first_at_least_sse(const long* residuals, long residual_nums, long size){
+    __m128i below = _mm_set1_epi64x(size - 1);
+    long index = 0;
+    for (; index + 2 <= residual_nums; index += 2){
+        __m128i values = _mm_loadu_si128((const __m128i*)(residuals + index));
+        int mask = _mm_movemask_pd(_mm_castsi128_pd(_mm_cmpgt_epi64(values, below)));
+        if (mask != 0) return index + __builtin_ctz(mask);
+    }
+    long tail = first_at_least_scalar(residuals + index, residual_nums - index, size);
+    return tail == -1 ? -1 : index + tail;
+}
+
+__attribute__((target("sse4.2")))
+inline long min_at_least_sse(const long* residuals, long residual_nums, long size){
+    __m128i below = _mm_set1_epi64x(size - 1);
+    __m128i none = _mm_set1_epi64x(LONG_MAX);
+    __m128i smallest = none;
+    long index = 0;
+    for (; index + 2 <= residual_nums; index += 2){
+        __m128i values = _mm_loadu_si128((const __m128i*)(residuals + index));
+        __m128i fitting = _mm_blendv_epi8(none, values, _mm_cmpgt_epi64(values, below));
+        smallest = _mm_blendv_epi8(smallest, fitting, _mm_cmpgt_epi64(smallest, fitting));
+    }
+    long lanes[2];
+    _mm_storeu_si128((__m128i*)lanes, smallest);
+    long smallest_value = min(lanes[0], lanes[1]);
+    for (long tail = index; tail < residual_nums; tail++){
+        if (residuals[tail] >= size) smallest_value = min(smallest_value, residuals[tail]);
+    }
+    if (smallest_value == LONG_MAX) return -1;
+
+    __m128i target = _mm_set1_epi64x(smallest_value);
+    for (index = 0; index + 2 <= residual_nums; index += 2){
+        __m128i values = _mm_loadu_si128((const __m128i*)(residuals + index));
+        int mask = _mm_movemask_pd(_mm_castsi128_pd(_mm_cmpeq_epi64(values, target)));
+        if (mask != 0) return index + __builtin_ctz(mask);
+    }
+    for (; index < residual_nums; index++){
+        if (residuals[index] == smallest_value) return index;
+    }
+    return -1;
+}
+
+__attribute__((target("sse4.2")))
+inline long filter_between_sse(const long* residuals, long residual_nums, long low, long high, long* indexes){
+    __m128i below = _mm_set1_epi64x(low - 1);
+    __m128i above = _mm_set1_epi64x(high);
+    long found_nums = 0;
+    long index = 0;
+    for (; index + 2 <= residual_nums; index += 2){
+        __m128i values = _mm_loadu_si128((const __m128i*)(residuals + index));
+        __m128i inside = _mm_andnot_si128(_mm_cmpgt_epi64(values, above), _mm_cmpgt_epi64(values, below));
+        int mask = _mm_movemask_pd(_mm_castsi128_pd(inside));
+        while (mask != 0){
+            indexes[found_nums++] = index + __builtin_ctz(mask);
+            mask &= mask - 1;
+        }
+    }
+    long tail_nums = filter_between_scalar(residuals + index, residual_nums - index, low, high, indexes + found_nums);
+    for (long tail = found_nums; tail < found_nums + tail_nums; tail++){
+        indexes[tail] += index;
+    }
+    return found_nums + tail_nums;
+}
+
+#endif //VNS_BPP_X86_KERNELS
+
+
+/*
+ * the ResidualKernels are the scan kernels picked for the processor the solver runs on, once for the process
+ */
+struct ResidualKernels{
+    long (*first_at_least)(const long* residuals, long residual_nums, long size);
+    long (*min_at_least)(const long* residuals, long residual_nums, long size);
+    long (*filter_between)(const long* residuals, long residual_nums, long low, long high, long* indexes);
+    const char* name;
+};
+
+inline ResidualKernels select_residual_kernels(){
+#ifdef VNS_BPP_X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return {first_at_least_avx2, min_at_least_avx2, filter_between_avx2, "avx2"};
+    if (__builtin_cpu_supports("sse4.2")) return {first_at_least_sse, min_at_least_sse, filter_between_sse, "sse4.2"};
+#endif
+    return {first_at_least_scalar, min_at_least_scalar, filter_between_scalar, "scalar"};
+}
+
+inline const ResidualKernels& residual_kernels(){
+    static const ResidualKernels kernels = select_residual_kernels();
+    return kernels;
+}
+
+} // namespace vns_bpp
+
+#endif //VNS_SIMD_H
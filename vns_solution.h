@@ -0,0 +1,1877 @@
+// Author: Feiyang Wang fy916
+// The search engine of the VNS bin packing solver: the items, bins and solutions, and the algorithms working on them.
+// This header is internal to the solver library, embedding applications use vns_bpp.h
+// For the detail implementation, please see the report.pdf
+
+#ifndef VNS_SOLUTION_H
+#define VNS_SOLUTION_H
+
+#include <vector>
+#include <cmath>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <atomic>
+#include <functional>
+#include <string>
+#include <ctime>
+
+#include "vns_scope_trace.h"
+#include "vns_simd.h"
+#include "vns_alloc_stats.h"
+
+
+namespace vns_bpp {
+
+using namespace std;
+
+/*
+ * the clock used for the time limits of the search, it is wall time so parallel searches share the same deadline
+ */
+typedef chrono::steady_clock search_clock;
+
+inline double seconds_between(search_clock::time_point time_start, search_clock::time_point time_fin){
+    return chrono::duration<double>(time_fin - time_start).count();
+}
+
+
+//the splitmix64 step, it turns consecutive numbers into well mixed ones, used to derive seeds
+inline uint64_t splitmix64(uint64_t* state){
+    uint64_t mixed = (*state += 0x9e3779b97f4a7c15ULL);
+    mixed = (mixed ^ (mixed >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    mixed = (mixed ^ (mixed >> 27)) * 0x94d049bb133111ebULL;
+    return mixed ^ (mixed >> 31);
+}
+
+//the seed of a numbered stream of the given seed, so the parallel searches of one seed are reproducible and distinct
+inline uint64_t derive_stream_seed(uint64_t seed, uint64_t stream){
+    uint64_t state = seed ^ splitmix64(&stream);
+    return splitmix64(&state);
+}
+
+
+/*
+ * the RandomGenerator is the xoshiro256** generator of Blackman and Vigna, each search owns one so no state is shared
+ * between threads. It is seeded with splitmix64 as its authors recommend.
+ */
+class RandomGenerator{
+private:
+    uint64_t state[4];
+
+    static uint64_t rotate_left(uint64_t value, int bits){ return (value << bits) | (value >> (64 - bits)); }
+
+public:
+    RandomGenerator(uint64_t seed = 39){ set_seed(seed); }
+
+    void set_seed(uint64_t seed){
+        for (int word = 0; word < 4; word++) state[word] = splitmix64(&seed);
+    }
+
+    uint64_t next(){
+        uint64_t result = rotate_left(state[1] * 5, 7) * 9;
+        uint64_t shifted = state[1] << 17;
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= shifted;
+        state[3] = rotate_left(state[3], 45);
+        return result;
+    }
+
+    //a number between min and max, both included, without the bias of taking the remainder
+    long uniform(long min, long max){
+        uint64_t range = (uint64_t)(max - min) + 1;
+        if (range == 0) return (long)next(); //the whole range of 64 bits
+        uint64_t limit = -range % range; //the numbers below it would make the small results more likely
+        uint64_t value;
+        do{
+            value = next();
+        } while (value < limit);
+        return min + (long)(value % range);
+    }
+};
+
+/*
+ * the Item class represents a simple item in the BPP problem
+ */
+class Item{
+private:
+    long item_ID;
+    long item_size;
+
+
+public:
+    Item(long itemID, long itemSize){ //Initialize value of the item
+        item_ID = itemID;
+        item_size = itemSize;
+    }
+    ~ Item(){}
+    long get_item_size() const {return item_size;} //getters for encapsulating attributes
+    long get_item_ID() const {return item_ID;}
+};
+
+
+/*
+ * the Item class represents a Bin in the BPP problem
+ */
+class Bin{
+private:
+    long bin_total_size;
+    long bin_remainnig_size;
+
+public:
+    vector<Item> items_in_bin; //the Item vector includes items in the bin
+
+
+    Bin(long binsize){ //initialize the Bin
+        bin_total_size = binsize;
+        bin_remainnig_size = binsize;
+    }
+
+    bool is_full() const { //check if the bin is full
+        return bin_remainnig_size == 0;
+    };
+
+    void reset_bin(){ //reset the bin to empty
+        bin_remainnig_size = bin_total_size;
+        while(items_in_bin.size()>0){items_in_bin.erase(items_in_bin.begin());}
+    }
+
+    bool add_item_to_bin(Item item){ //add an item to the bin, and make the smallest on the top
+        long item_size = item.get_item_size();
+
+        //make the smallest item on the top in the bin
+        if (item_size <= bin_remainnig_size){
+            for (long i = 0; i < items_in_bin.size(); i++){
+                if (item_size <= items_in_bin[i].get_item_size()){
+                    items_in_bin.insert(items_in_bin.begin()+i, item);
+                    bin_remainnig_size = bin_remainnig_size - item.get_item_size();
+                    return true;
+                }
+            }
+
+            items_in_bin.push_back(item);//if the new item is the largest, put it to the buttom
+            bin_remainnig_size = bin_remainnig_size - item.get_item_size();
+            return true;
+        } else {
+            return false;
+        }
+    }
+
+    long get_remaining_size() const {
+        return bin_remainnig_size;
+    }
+
+    bool remove_item_from_bin(long item_id){ //remove a item from the bin
+        for (long i =0; i<items_in_bin.size(); i++){
+            if (items_in_bin.at(i).get_item_ID() == item_id){ //if the item is in the bin
+                bin_remainnig_size += items_in_bin.at(i).get_item_size(); //update bin size
+                items_in_bin.erase(items_in_bin.begin()+i);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool remove_nth_item_from_bin (long nth_index){ //remove the nth element in the bin
+        if (nth_index < items_in_bin.size()) {
+            bin_remainnig_size += items_in_bin.at(nth_index).get_item_size(); //update remaining size
+            items_in_bin.erase(items_in_bin.begin()+nth_index); // remove the nth element
+            return true;
+        }
+        return false;
+    }
+
+    bool is_item_exists(long item_id) const { //check if an item exists in the bin
+        for (long i =0; i<items_in_bin.size(); i++){
+            if (items_in_bin.at(i).get_item_ID() == item_id){
+                return true;
+            }
+        }
+        return false; //if not found, return false
+    }
+
+    long get_item_size(long item_id) const { //check the size of the item in the bin
+        for (long i =0; i<items_in_bin.size(); i++){
+            if (items_in_bin.at(i).get_item_ID() == item_id){
+                return items_in_bin.at(i).get_item_size(); //return the item size
+            }
+        }
+        return 0; //if not found the item in the bin, return 0
+    }
+
+    Item get_item(long item_id) const { //getter which returns the item in the bin
+        for (long i =0; i<items_in_bin.size(); i++){
+            if (items_in_bin.at(i).get_item_ID() == item_id){
+                return items_in_bin.at(i);
+            }
+        }
+        return Item(0,0); //if not found, return a empty item
+    }
+
+    int get_item_nums() const {return items_in_bin.size();}
+
+    bool is_empty() const { //check if the bin is empty
+        if(items_in_bin.size() == 0) return true;
+        return false;
+    }
+};
+
+
+/*
+ * the PersistentSolution class is a list of bins in which the bins are shared between copies.
+ * Copying a solution (taking a snapshot) only copies the bin handles, the items are not copied.
+ * A bin is deep copied the first time it is modified while it is still shared with another snapshot (copy on write),
+ * so a snapshot only pays for the bins touched by the moves since it was taken.
+ */
+class PersistentSolution{
+private:
+    vector<shared_ptr<Bin>> bins; //the handles of the bins, shared with other snapshots
+
+public:
+    //iterator going through the bins in the solution as read-only bins
+    class const_iterator{
+    private:
+        vector<shared_ptr<Bin>>::const_iterator handle;
+    public:
+        const_iterator(vector<shared_ptr<Bin>>::const_iterator it){handle = it;}
+        const Bin& operator*() const {return **handle;}
+        const Bin* operator->() const {return handle->get();}
+        const_iterator& operator++(){++handle; return *this;}
+        bool operator!=(const const_iterator& other) const {return handle != other.handle;}
+    };
+
+    PersistentSolution(){}
+
+    PersistentSolution(const vector<Bin>& given_bins){ //build the solution from plain bins
+        for (auto &bin: given_bins){
+            bins.push_back(make_shared<Bin>(bin));
+        }
+    }
+
+    long size() const {return bins.size();}
+    bool empty() const {return bins.empty();}
+    const_iterator begin() const {return const_iterator(bins.begin());}
+    const_iterator end() const {return const_iterator(bins.end());}
+
+    const Bin& operator[](long index) const {return *bins[index];}
+    const Bin& at(long index) const {return *bins.at(index);}
+
+    Bin& modify(long index){ //get a writable bin, it is copied first if other snapshots are still sharing it
+        shared_ptr<Bin> &bin = bins.at(index);
+        if (bin.use_count() > 1){
+            bin = make_shared<Bin>(*bin);
+        }
+        return *bin;
+    }
+
+    void push_back(const Bin& bin){bins.push_back(make_shared<Bin>(bin));}
+
+    void erase(long index){bins.erase(bins.begin()+index);} //remove the bin from this snapshot only
+
+    //sort the bins according to the remaining size in descending order, the bins are shared and not copied
+    void sort_by_remaining_size(){
+        VNS_TRACE_SCOPE("sort bins");
+        stable_sort(bins.begin(), bins.end(), [](const shared_ptr<Bin>& bin_a, const shared_ptr<Bin>& bin_b){
+            return bin_a->get_remaining_size() > bin_b->get_remaining_size();
+        });
+    }
+
+    vector<Bin> to_bins() const { //copy the solution out to plain bins
+        vector<Bin> plain_bins;
+        for (auto &bin: bins){
+            plain_bins.push_back(*bin);
+        }
+        return plain_bins;
+    }
+};
+
+
+
+
+//check if a solution is better than another according to the sum of square of the bins' remaining sizes (optimity)
+//the new solution is better only if its optimity is larger than the old one at some extent
+inline bool is_better_optimity(long old_sln_optimity, long new_sln_optimity){
+    return (double)new_sln_optimity/(double)old_sln_optimity > 1.01;
+}
+
+
+//set the positions to the first combination of N items out of item_nums, returns false if the bin has not enough items
+template <int N>
+inline bool first_combination(array<long, N>& positions, long item_nums){
+    if (N > item_nums) return false;
+    for (int i = 0; i < N; i++) positions[i] = i;
+    return true;
+}
+
+//step the positions to the next combination of N items out of item_nums, returns false if all have been visited
+template <int N>
+inline bool next_combination(array<long, N>& positions, long item_nums){
+    for (int i = N-1; i >= 0; i--){
+        if (positions[i] < item_nums - N + i){
+            positions[i]++;
+            for (int j = i+1; j < N; j++) positions[j] = positions[j-1] + 1;
+            return true;
+        }
+    }
+    return false;
+}
+
+//the total size of the items at the positions in the bin
+template <int N>
+inline long combination_size(const Bin& bin, const array<long, N>& positions){
+    long size = 0;
+    for (int i = 0; i < N; i++) size += bin.items_in_bin[positions[i]].get_item_size();
+    return size;
+}
+
+
+/*
+ * the SwapEvaluation decides if a swap between bin A and bin B makes the solution better,
+ * only the two bins change so the optimity of the new solution is updated from the old one
+ */
+struct SwapEvaluation{
+    long old_sln_optimity; //the sum of square of the remaining sizes of the whole solution
+    long bin_A_remaining_size;
+    long bin_B_remaining_size;
+
+    bool is_better(long new_A_remaining_size, long new_B_remaining_size, bool bin_A_emptied) const {
+        if (bin_A_emptied) return true; //the solution has one bin less, it is no doubt better
+        long new_sln_optimity = old_sln_optimity
+                - bin_A_remaining_size*bin_A_remaining_size - bin_B_remaining_size*bin_B_remaining_size
+                + new_A_remaining_size*new_A_remaining_size + new_B_remaining_size*new_B_remaining_size;
+        return is_better_optimity(old_sln_optimity, new_sln_optimity);
+    }
+};
+
+
+/*
+ * the swap_kernel searches the swaps of K items from bin A with L items from bin B (K-L swap)
+ * The combinations are kept in fixed size arrays, so each K-L shape gets its own allocation free loop
+ * which the compiler can unroll, and a new neighbourhood shape only needs a new instantiation.
+ */
+template <int K, int L>
+struct swap_kernel{
+    //find the first feasible swap which makes the solution better, the positions of the items swapped are returned
+    static bool search(const Bin& bin_A, const Bin& bin_B, const SwapEvaluation& evaluation,
+                       array<long, K>& positions_A, array<long, L>& positions_B){
+        long bin_A_item_nums = bin_A.get_item_nums();
+        long bin_B_item_nums = bin_B.get_item_nums();
+        long bin_A_remaining_size = bin_A.get_remaining_size();
+        long bin_B_remaining_size = bin_B.get_remaining_size();
+        bool bin_A_emptied = (K == bin_A_item_nums and L == 0);
+
+        if (!first_combination<K>(positions_A, bin_A_item_nums)) return false;
+        do{
+            long items_A_size = combination_size<K>(bin_A, positions_A);
+            if (!first_combination<L>(positions_B, bin_B_item_nums)) return false;
+            do{
+                long items_B_size = combination_size<L>(bin_B, positions_B);
+                long new_A_remaining_size = bin_A_remaining_size + items_A_size - items_B_size;
+                long new_B_remaining_size = bin_B_remaining_size + items_B_size - items_A_size;
+                if (new_A_remaining_size < 0 or new_B_remaining_size < 0) continue; //not enough space for the swap
+
+                if (evaluation.is_better(new_A_remaining_size, new_B_remaining_size, bin_A_emptied)) return true;
+            } while (next_combination<L>(positions_B, bin_B_item_nums));
+        } while (next_combination<K>(positions_A, bin_A_item_nums));
+        return false;
+    }
+};
+
+
+
+
+
+//the CPU time used by the calling thread, each search runs on its own thread
+inline double thread_cpu_seconds(){
+    timespec cpu_time;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu_time);
+    return cpu_time.tv_sec + cpu_time.tv_nsec * 1e-9;
+}
+
+
+/*
+ * the NeighbourhoodSelector orders the neighbourhoods of a descent by their yield: the improvements each one found
+ * per CPU second it ran, averaged with a decay so the order follows the phase of the search. Every neighbourhood
+ * is still tried once before the descent ends, the ones not run yet go first.
+ */
+class NeighbourhoodSelector{
+private:
+    vector<double> scores; //the decayed improvements per CPU second
+    vector<bool> used; //the neighbourhood has been run at least once
+    vector<bool> tried; //the neighbourhood has been run in the current descent
+    double decay;
+
+public:
+    NeighbourhoodSelector(int neighbourhood_nums, double score_decay){
+        scores.assign(neighbourhood_nums, 0);
+        used.assign(neighbourhood_nums, false);
+        tried.assign(neighbourhood_nums, false);
+        decay = score_decay;
+    }
+
+    void start_descent(){ tried.assign(tried.size(), false); }
+
+    int next(){ //the neighbourhood with the best yield among the ones not tried in this descent
+        int best_index = -1;
+        for (int nb_indx = 0; nb_indx < scores.size(); nb_indx++){
+            if (tried[nb_indx]) continue;
+            if (!used[nb_indx]) return nb_indx;
+            if (best_index == -1 or scores[nb_indx] > scores[best_index]) best_index = nb_indx;
+        }
+        return best_index;
+    }
+
+    void record(int nb_indx, double gain, double cpu_seconds){
+        double yield = gain / max(cpu_seconds, 1e-6);
+        scores[nb_indx] = used[nb_indx] ? decay * scores[nb_indx] + (1 - decay) * yield : yield;
+        used[nb_indx] = true;
+        tried[nb_indx] = true;
+    }
+};
+
+
+/*
+ * The Solution class defines the solution of the BPP problem along with the algorithms used.
+ */
+class Solution{
+private:
+    long bin_capacity;
+    long best_known_bins;
+    long lower_bound = 0; //no solution can have fewer bins, the search stops when it is reached
+    vector<Bin> final_solution; //store the final solution
+    vector<Item> original_items;
+    vector<long> initial_bin_of_item; //a previous assignment to start the search from, -1 for the items not assigned
+    vector<uint64_t> subset_sum_table; //the scratch bitsets used by the 1-n swap, only grown so it is allocated once
+    long subset_sum_words = 0;
+    long subset_sum_rows = 0;
+    vector<long> residual_buffer; //the remaining size of each bin for the scan kernels, cleared but kept between the calls
+
+    //the parameters of the search
+    double max_time = 0; //the time allowed for the search, in seconds
+    long shaking_strength = 4;
+    long shaking_max_try = 2000;
+    long ruin_least_filled_bins = 2; //the least filled bins emptied by the first ruin and recreate
+    long ruin_random_bins = 1; //the random bins emptied by the first ruin and recreate
+    double ruin_max_fraction = 0.3; //the largest part of the bins a ruin and recreate may empty
+    long subset_sum_max_size = 1 << 20; //the largest item size the 1-n swap builds a subset-sum table for
+
+    RandomGenerator random_engine; //each search has its own random numbers
+    const atomic<bool>* stop_flag = nullptr; //set by another search to stop this one early
+    function<void(const PersistentSolution&, double, const string&)> new_best_callback;
+    function<void(const string&)> message_callback;
+    bool adaptive_neighbourhoods = true; //order the neighbourhoods by their yield instead of always from the first
+    double neighbourhood_score_decay = 0.8;
+    long stall_rounds = 100; //the shakings without saving a bin after which the search is considered stuck
+    function<vector<Bin>(const PersistentSolution&)> stall_solver; //tries to beat a stuck search, returns no bins if it can not
+    double migration_interval = 0; //the seconds between two exchanges with the other islands, 0 never
+    function<void(const vector<Bin>&)> emigrate; //sends the best solution to the next island
+    function<bool(vector<Bin>*)> immigrate; //takes the solution sent by the previous island, false if there is none
+
+public:
+    void set_bin_capacity(long capacity){ bin_capacity = capacity; }
+    void set_best_known_bins(long bins){best_known_bins = bins;}
+    void set_lower_bound(long bins){lower_bound = bins;}
+    void set_adaptive_neighbourhoods(bool adaptive){adaptive_neighbourhoods = adaptive;}
+    void set_original_items(vector<Item> items){original_items = items;}
+    void set_initial_assignment(vector<long> bin_of_item){initial_bin_of_item = bin_of_item;}
+    void set_max_time(double seconds){max_time = seconds;}
+    void set_seed(uint64_t seed){random_engine.set_seed(seed);}
+    void set_stop_flag(const atomic<bool>* flag){stop_flag = flag;}
+    void set_new_best_callback(function<void(const PersistentSolution&, double, const string&)> callback){new_best_callback = callback;}
+    void set_message_callback(function<void(const string&)> callback){message_callback = callback;}
+    void set_stall_solver(long rounds, function<vector<Bin>(const PersistentSolution&)> solver){stall_rounds = rounds; stall_solver = solver;}
+    void set_migration(double seconds, function<void(const vector<Bin>&)> send, function<bool(vector<Bin>*)> receive){
+        migration_interval = seconds; emigrate = send; immigrate = receive;
+    }
+    vector<Bin> get_final_solution(){return final_solution;}
+
+
+    //generate random number between min and max, both included
+    long rand_int(long min, long max)
+    {
+        return random_engine.uniform(min, max);
+    }
+
+    bool stop_requested(){ //check if another search has asked this one to stop
+        return stop_flag != nullptr and stop_flag->load();
+    }
+
+    void report_message(const string& message){ //pass the message to the caller instead of printing it
+        if (message_callback) message_callback(message);
+    }
+
+    //pass the new best solution to the caller, with the seconds since the search started and the neighbourhood which found it
+    void report_new_best(const PersistentSolution& best_solution, search_clock::time_point time_start, const string& neighbourhood){
+        if (new_best_callback) new_best_callback(best_solution, seconds_between(time_start, search_clock::now()), neighbourhood);
+    }
+
+    //the name of each neighbourhood of first_descent_vns, used in the improvement reports
+    static const char* neighbourhood_name(int nb_indx){
+        static const char* names[] = {"1-1-1 swap", "1-0 move", "1-1 swap", "1-2 swap", "2-2 swap", "1-n swap"};
+        return (nb_indx >= 0 and nb_indx < 6) ? names[nb_indx] : "unknown";
+    }
+
+
+    //best fit algorithm that fits the items in the bin
+    vector<Bin> best_fit(vector<Item> items){
+        vector<Item> sorted_items_descending = sort_items_descending(items); // sort the items according to size first, from large to small
+        vector<Bin> bins;
+        vector<long> &residuals = residual_buffer; //the remaining size of each bin, kept next to the bins for the scan kernels
+        residuals.clear();
+
+        for (auto item :sorted_items_descending){ //go through every item
+            long best_bin_index = find_best_bin(residuals, item.get_item_size()); //find the most suitable bin for the item (best fit)
+            if (best_bin_index!= -1){//if there is a suitable bin
+                if(!bins.at(best_bin_index).add_item_to_bin(item)){ //add the new item to the bin
+                    report_message("error adding object");
+                }
+                residuals[best_bin_index] = bins[best_bin_index].get_remaining_size();
+            }
+            else{//if there is no suitable bin
+                Bin created_bin(bin_capacity);
+                if (!created_bin.add_item_to_bin(item)){ //create a new bin and put the item in it
+                    report_message("error adding object");
+                }
+                bins.push_back(created_bin); //add the new bin to solutions
+                residuals.push_back(created_bin.get_remaining_size());
+            }
+        }
+        return bins;
+    }
+
+
+    //finds the best bin for item to fit in, whose remaining size >= the item size and is mostly close the the item size
+    //the first such bin is taken on a tie, the residuals are the remaining sizes of the bins
+    long find_best_bin(const vector<long>& residuals, long item_size){
+        return residual_kernels().min_at_least(residuals.data(), residuals.size(), item_size);
+    }
+
+    vector<Bin> best_fit_on_bin(vector<Bin> originalBins){ //this function applies best fit on bin solutions
+        vector<Bin> final_bins;
+        vector<Bin> to_be_processed;
+        vector<Bin> processed;
+        vector<Item> items_to_be_processed;
+
+        for (auto bin: originalBins){ //go through the given bins
+            if(bin.is_full()){//if the bin is full then directly add to the solution
+                final_bins.push_back(bin);
+            }else{//if the bin is not full, add to the list to be applied the best fit
+                to_be_processed.push_back(bin);
+            }
+        }
+
+        for(auto bin: to_be_processed){//go through the pending list
+            for(auto item: bin.items_in_bin){
+                items_to_be_processed.push_back(item); //extract all the elements from the list
+            }
+        }
+
+        processed = best_fit(items_to_be_processed); //apply best fit on the items
+
+        for (auto bin: processed){ //add the re-fit bins to the solution
+            final_bins.push_back(bin);
+        }
+        return final_bins;
+    }
+
+
+
+    //This minimum bin slack fit is proposed by a research paper 'A new heuristic algorithm for the one dimensional bin packing problem'
+    //The algorithm has been adapted a bit to quickly calculate a solution which is used for VNS base solution
+    vector<Bin> best_fit_on_minimum_bin_slack(vector<Item> original_items){
+        VNS_TRACE_SCOPE("minimum bin slack");
+        VNS_ALLOC_PHASE("minimum bin slack");
+        vector<Bin> solution;
+        vector<Item> sorted_pending_items = sort_items_descending(original_items); //the pending items waiting to be added to the bin
+        vector<Item> removed_from_bin_list; //store the items that are removed in the backtracking process
+
+        long total_remaining_items_counter = original_items.size(); //note the total remaining items that are not added yet
+        long pending_items_size = original_items.size();
+
+        Bin current_bin(bin_capacity); //the current try of bin including items
+        Bin best_bin(bin_capacity); //find the best solution for one bin
+
+        //find solution for all items
+        while(total_remaining_items_counter > 0){
+
+            //trying to find best solution for the current bin
+            while(pending_items_size > 0){
+                long item_counter = 0;
+
+                //go through each item in the waiting list
+                while(item_counter < pending_items_size) {
+                    Item current_pending_item = sorted_pending_items[item_counter]; //get the item to try to add to a bin
+                    if (current_bin.add_item_to_bin(current_pending_item)){ //if the item can be added to the bin
+                        sorted_pending_items.erase(sorted_pending_items.begin()+item_counter); //delete it from the pending list
+                        pending_items_size = sorted_pending_items.size(); //update the pending list size
+                    }else{
+                        item_counter++; //if the item can not be added, seek for the next smaller item
+                    }
+                }
+
+                //when one search is complete, check if result is better
+                if (best_bin.is_empty()) { //if the best bin is not intialized, set it as the current one
+                    best_bin = current_bin;
+                }else if(best_bin.get_remaining_size() > current_bin.get_remaining_size()){
+                    //if the best bin is not as full as the current bin, set the current bin as best
+                    best_bin = current_bin;
+                }
+                if(best_bin.get_remaining_size() == 0){
+                    //if the best bin is full, the bin is optimal and can be added to the solution list, skip the next back tracking process
+                    break;
+                }
+                //if the best bin is not full, apply back tracking
+                removed_from_bin_list.push_back(current_bin.items_in_bin[0]);  //add the top item in the bin to the removed list
+                current_bin.remove_nth_item_from_bin(0);
+                pending_items_size = sorted_pending_items.size(); //update the pending item list
+            }
+
+
+            //when there is no item could be tested to add to the bin, add the best bin, which is although not full, to the solution list
+            for (auto item: current_bin.items_in_bin){
+                removed_from_bin_list.push_back(item); //add all the current bin items to the removed waiting list
+            }
+
+
+            for(auto item: sorted_pending_items){
+                removed_from_bin_list.push_back(item); //if the bin is full and the remaining search is skipped, add all the pending items to the removed waiting list
+            }
+
+            sorted_pending_items = sort_items_descending(removed_from_bin_list); //reset all the removed items to the pending list
+
+            for (auto item: best_bin.items_in_bin){ //delete the items in the best bin from the pending list
+                long item_index_in_pending_item = 0;
+                while(item_index_in_pending_item < sorted_pending_items.size()){
+                    if (sorted_pending_items[item_index_in_pending_item].get_item_ID() == item.get_item_ID()){
+                        sorted_pending_items.erase(sorted_pending_items.begin()+item_index_in_pending_item);
+                        break; //if found and deleted, skip the remaining search
+                    } else{
+                        item_index_in_pending_item++; //if not found in the list, keep searching
+                    }
+                }
+            }
+
+            total_remaining_items_counter -= best_bin.get_item_nums(); //update the total counter
+            solution.push_back(best_bin);//add the best bin to the solution list
+            best_bin.reset_bin(); //reset the bin for new round of adding
+            current_bin.reset_bin();
+            pending_items_size = sorted_pending_items.size();
+            removed_from_bin_list.clear(); //keep finding the optimal bins until all of the items are in the bin
+        }
+
+        vector<Bin> newsln = best_fit_on_bin(solution); //use best fit for the non full bins
+        if(evaluate_solution(solution,newsln)){//if the best fit is better, use the best fit solution
+            return newsln;
+        }
+        return solution;
+    }
+
+
+    //build the bins of the previous assignment, the items which do not fit anymore and the items not assigned are added with best fit
+    //this repairs an assignment made before items were added, removed or resized
+    vector<Bin> repair_initial_assignment(){
+        VNS_TRACE_SCOPE("warm start repair");
+        VNS_ALLOC_PHASE("warm start repair");
+        long bin_nums = 0;
+        for (long bin_index: initial_bin_of_item){
+            if (bin_index >= 0 and bin_index < (long)initial_bin_of_item.size()) bin_nums = max(bin_nums, bin_index + 1);
+        }
+
+        //put the items back in their previous bins as long as they fit
+        vector<Bin> previous_bins(bin_nums, Bin(bin_capacity));
+        vector<Item> pending_items;
+        for (auto &item: original_items){
+            long bin_index = item.get_item_ID() < initial_bin_of_item.size() ? initial_bin_of_item[item.get_item_ID()] : -1;
+            if (bin_index < 0 or bin_index >= bin_nums or !previous_bins[bin_index].add_item_to_bin(item)){
+                pending_items.push_back(item);
+            }
+        }
+
+        vector<Bin> bins;
+        vector<long> &residuals = residual_buffer;
+        residuals.clear();
+        for (auto &bin: previous_bins){ //the bins whose items were all removed are dropped
+            if (bin.is_empty()) continue;
+            bins.push_back(bin);
+            residuals.push_back(bin.get_remaining_size());
+        }
+
+        //best fit the pending items, from large to small
+        for (auto &item: sort_items_descending(pending_items)){
+            long best_bin_index = find_best_bin(residuals, item.get_item_size());
+            if (best_bin_index != -1){
+                bins.at(best_bin_index).add_item_to_bin(item);
+                residuals[best_bin_index] = bins[best_bin_index].get_remaining_size();
+            }else{
+                Bin created_bin(bin_capacity);
+                if (!created_bin.add_item_to_bin(item)){
+                    report_message("error adding object");
+                }
+                bins.push_back(created_bin);
+                residuals.push_back(created_bin.get_remaining_size());
+            }
+        }
+        return bins;
+    }
+
+
+    //the MAIN entrance of the VNS search
+    vector<Bin> varaible_neighbourhood_search(){
+        VNS_ALLOC_PHASE("search"); //the loop itself, the phases inside it count their own allocations
+        try{
+            //record the start time
+            search_clock::time_point time_start, time_fin;
+            time_start = search_clock::now();
+            double time_spent=0;
+
+
+            //the solutions are snapshots sharing their unchanged bins, so keeping the best one costs only the touched bins
+            //start from the previous assignment if one is given, otherwise construct the solution with MBS
+            PersistentSolution initial_solution(initial_bin_of_item.empty() ? best_fit_on_minimum_bin_slack(original_items)
+                                                                            : repair_initial_assignment());
+            PersistentSolution best_solution = initial_solution; //records the best solution
+            PersistentSolution current_solution = initial_solution; // records the current solution
+            report_new_best(best_solution, time_start, initial_bin_of_item.empty() ? "minimum bin slack" : "warm start");
+            int VNS_K = 6;  //total of 6 types of VNS
+            int nb_index = 0; //the neighbourhoods tried since the last improvement
+            NeighbourhoodSelector selector(VNS_K, neighbourhood_score_decay);
+            long shaking_rounds = 0; //the number of shakings since the last time a bin is saved
+            search_clock::time_point last_migration = time_start;
+
+            while(true) { //keep searching until the time is up or the solution is the best known bins
+                //sort the bins, with the most empty at the first of the bin lists
+                current_solution.sort_by_remaining_size();
+                check_solution_correctness(current_solution, original_items);
+
+                while(nb_index < VNS_K){//go through the neighbourhoods
+                    time_fin=search_clock::now();
+                    time_spent = seconds_between(time_start, time_fin);//check the time when a neighbour is searched
+                    if (time_spent >= max_time or best_solution.size() <= max(best_known_bins, lower_bound) or stop_requested()) {//if time is up or optimal is found
+                        if (check_solution_correctness(best_solution, original_items)){ //check integrity of the best solution
+                            final_solution = best_solution.to_bins(); //return the best solution
+                            return final_solution;
+                            //if the integrity of the solution is incorrect, step back for MBS or Best fit
+                            //Although the integrity test has been carried out many times and no issues were found
+                            //This is a backup back tracking which is not likely to be used
+                        }else if (check_solution_correctness(initial_solution, original_items)){
+                            report_message("solution incorrect");
+                            final_solution = initial_solution.to_bins();
+                            return final_solution;
+                        }else{
+                            report_message("solution incorrect");
+                            final_solution = best_fit(original_items);
+                            return final_solution;
+                        }
+                    }
+
+                    //in the fixed order the neighbourhoods are tried from the first, otherwise the best yield goes first
+                    if (nb_index == 0) selector.start_descent();
+                    int neighbourhood = adaptive_neighbourhoods ? selector.next() : nb_index;
+                    long bins_before = current_solution.size();
+                    double cpu_start = thread_cpu_seconds();
+
+                    bool better_solution = false;
+                    //run first descent variable neighbourhood search
+                    current_solution = first_descent_vns(&better_solution, neighbourhood, current_solution, time_start);
+                    //a saved bin is worth many small improvements
+                    double gain = better_solution ? 1 + 10 * max(0L, bins_before - (long)current_solution.size()) : 0;
+                    selector.record(neighbourhood, gain, thread_cpu_seconds() - cpu_start);
+                    //check the correctness of the solution
+                    bool if_correct = check_solution_correctness(current_solution, original_items);
+                    if(!if_correct){ //if the solution is incorrect, back track to use initial solution
+                        //all tests carried have not show evidence that this could go incorrect
+                        //just a backup back tracking the same as the above
+                        current_solution = initial_solution;
+                    }
+
+                    if (better_solution){//if the solution is better
+                        if (current_solution.size() < best_solution.size()){
+                            shaking_rounds = 0; //a bin is saved, the search is not stuck anymore
+                        }
+                        //if the solution is better than best, set the best to the current one
+                        //a shaken solution can have more bins than the best, and then it does not replace the best
+                        if (current_solution.size() <= best_solution.size()){
+                            best_solution = current_solution;
+                            report_new_best(best_solution, time_start, neighbourhood_name(neighbourhood));
+                        }
+                        nb_index = 0; //back to the first neighborhood to search again
+                    }
+                    else{
+                        nb_index++; //if solution is not better, seek for the neighbourhood's solution
+                    }
+                }
+                //the search has been stuck for long, let the stall solver try to save a bin
+                if (shaking_rounds == stall_rounds and stall_solver){
+                    vector<Bin> better_bins;
+                    {
+                        VNS_TRACE_SCOPE("branch and bound");
+                        VNS_ALLOC_PHASE("branch and bound");
+                        better_bins = stall_solver(best_solution);
+                    }
+                    if (!better_bins.empty() and better_bins.size() < best_solution.size()
+                        and check_solution_correctness(better_bins, original_items)){
+                        best_solution = PersistentSolution(better_bins);
+                        report_new_best(best_solution, time_start, "branch and bound");
+                        current_solution = best_solution;
+                        shaking_rounds = 0;
+                        nb_index = 0;
+                        continue;
+                    }
+                }
+                //in the island mode, the best solution is sent to the next island from time to time, and the one
+                //received from the previous island is crossed with it instead of shaking
+                if (migration_interval > 0 and seconds_between(last_migration, search_clock::now()) >= migration_interval){
+                    last_migration = search_clock::now();
+                    emigrate(best_solution.to_bins());
+                    vector<Bin> migrant;
+                    if (immigrate(&migrant) and check_solution_correctness(migrant, original_items)){
+                        current_solution = grouping_crossover(best_solution, migrant);
+                        if (current_solution.size() < best_solution.size()){
+                            best_solution = current_solution;
+                            report_new_best(best_solution, time_start, "grouping crossover");
+                            shaking_rounds = 0;
+                        }else{
+                            shaking_rounds++;
+                        }
+                        nb_index = 0;
+                        continue;
+                    }
+                }
+                //since all neighbourhoods have been searched and no better solution shows, do VNS shaking
+                //the first shaking only swaps a few items, if the search keeps being stuck use ruin and recreate
+                if (shaking_rounds == 0){
+                    current_solution = vns_shaking(best_solution, original_items.size(),time_start);
+                }else{
+                    current_solution = vns_ruin_and_recreate(best_solution, shaking_rounds);
+                }
+                shaking_rounds++;
+                nb_index = 0;
+            }
+        }catch (exception e){ //catch exceptions, just as a back up when runtime error occurs
+            //the tests carried did not show issues and thus this piecce of codes are not likely to be executed.
+            vector<Bin> initial_solution = best_fit_on_minimum_bin_slack(original_items); //if run time issues occurred, use MBS
+            if (check_solution_correctness(initial_solution, original_items)){
+                final_solution = initial_solution;
+                return final_solution;
+            } else{
+                final_solution = best_fit(original_items); //if MBS incorrect, use Best fit
+                return final_solution;
+            }
+        }
+        final_solution = best_fit(original_items); //if no results found, return best fit
+        return final_solution;
+    }
+
+
+
+    //the neighbourhood searches are carried in a first descent form since the complete best search may cost too much time
+    PersistentSolution first_descent_vns (bool* is_better, int nb_indx, const PersistentSolution& given_solution, search_clock::time_point time_start){
+        VNS_TRACE_SCOPE(neighbourhood_name(nb_indx));
+        VNS_ALLOC_PHASE(neighbourhood_name(nb_indx));
+        switch(nb_indx){
+            case 0: // 1-1-1 swap
+                return first_descent_vns_0(is_better, given_solution, time_start);
+            case 1: // 1 to 0 swap
+                return first_descent_vns_1(is_better, given_solution, time_start);
+            case 2: // 1 to 1 swap
+                return first_descent_vns_2(is_better, given_solution, time_start);
+            case 3: // 1 to 2 swap
+                return first_descent_vns_3(is_better, given_solution, time_start);
+            case 4: // 2 to 2 swap
+                return first_descent_vns_4(is_better, given_solution, time_start);
+            case 5: // 1 to n swap
+                return first_descent_vns_5(is_better, given_solution, time_start);
+            default:
+                return given_solution;
+        }
+        return given_solution;
+    }
+
+    //VNS shaking shakes at a certain strength when no better solution is found
+    PersistentSolution vns_shaking(const PersistentSolution& given_solution, long item_nums, search_clock::time_point time_start){
+        VNS_TRACE_SCOPE("shaking");
+        VNS_ALLOC_PHASE("shaking");
+        int shake_time = 0;
+        int trycounter = 0;
+        PersistentSolution current_solution = given_solution;
+        vector<long> moved_list; //note the items that are moved already and prevent duplicate move
+
+        //note the time
+        search_clock::time_point time_fin, time_start_session;
+        double time_spent=0;
+        double time_spent_session= 0;
+        time_start_session = search_clock::now();
+
+        //set the shake times, and the total allowed operating trys to avoid costing too much time
+        while(shake_time < shaking_strength && trycounter<shaking_max_try){
+            time_fin=search_clock::now();
+            time_spent = seconds_between(time_start, time_fin);
+            time_spent_session = seconds_between(time_start_session, time_fin);
+            if (time_spent >= max_time or stop_requested() or time_spent_session > 5){//if time limit reaches, break the shaking process
+                break;
+            }
+            //randomly choose two items and swap
+            long index1 = rand_int(0, item_nums-1);
+            long index2 = rand_int(0, item_nums-1);
+            if (index1 == index2) continue; //skip if the two are the same
+
+            bool have_moved = false;
+            long moved_list_lim = moved_list.size()-1;
+
+            for(int i = 0; i < moved_list_lim; i+=2){ //check if the two items have been swapped before
+                if((moved_list[i] == index1 and moved_list[i+1] == index2) or(moved_list[i] == index2 and moved_list[i+1] == index1)){
+                    have_moved = true;
+                    break;
+                }
+            }
+
+            if (have_moved) continue; //if has been moved, skip the current move
+
+            bool move_successful = false;
+            //add the two indexes to the move list
+            vector<long> indexes_to_be_moved_A;
+            vector<long> indexes_to_be_moved_B;
+            indexes_to_be_moved_A.push_back(index1);
+            indexes_to_be_moved_B.push_back(index2);
+            moved_list.push_back(index1);
+            moved_list.push_back(index2);
+            //apply move between two bins
+            current_solution = apply_move(&move_successful, current_solution, indexes_to_be_moved_A, indexes_to_be_moved_B);
+            if (move_successful) shake_time++; //if move successful, add the shake successful counter
+            trycounter++;
+        }
+        return current_solution;
+    }
+
+
+
+    //ruin and recreate shaking, empties the least filled bins and some random bins and repacks their items with best fit decreasing
+    //the more shakings since the last saved bin, the more bins are emptied
+    PersistentSolution vns_ruin_and_recreate(const PersistentSolution& given_solution, long shaking_rounds){
+        VNS_TRACE_SCOPE("ruin and recreate");
+        VNS_ALLOC_PHASE("ruin and recreate");
+        //sort the bins, with the most empty at the first of the bin lists
+        PersistentSolution current_solution = sort_bin_according_to_remaining_size(given_solution);
+        long bin_nums = current_solution.size();
+        long max_ruined = max(1L, (long)(bin_nums * ruin_max_fraction));
+
+        long least_filled_nums = min(max_ruined, ruin_least_filled_bins + shaking_rounds);
+        long random_nums = min(max_ruined - least_filled_nums, ruin_random_bins + shaking_rounds/2);
+
+        //mark the bins to be emptied, the least filled ones are at the front
+        vector<bool> is_ruined(bin_nums, false);
+        for (long bin_index = 0; bin_index < least_filled_nums; bin_index++){
+            is_ruined[bin_index] = true;
+        }
+        for (long picked = 0; picked < random_nums and least_filled_nums + picked < bin_nums; ){
+            long bin_index = rand_int(least_filled_nums, bin_nums-1);
+            if (is_ruined[bin_index]) continue; //skip if the bin has been picked
+            is_ruined[bin_index] = true;
+            picked++;
+        }
+
+        //take the items out of the emptied bins, going backwards so the indexes stay valid while erasing
+        vector<Item> freed_items;
+        for (long bin_index = bin_nums-1; bin_index >= 0; bin_index--){
+            if (!is_ruined[bin_index]) continue;
+            for (auto &item: current_solution[bin_index].items_in_bin){
+                freed_items.push_back(item);
+            }
+            current_solution.erase(bin_index);
+        }
+
+        //recreate, put the freed items back with best fit decreasing
+        repack_best_fit_decreasing(&current_solution, freed_items);
+        return current_solution;
+    }
+
+
+    //grouping crossover of two solutions: the fullest bins of both parents are inherited as long as they share no item
+    //with a bin inherited before, and the items left are packed back with best fit decreasing
+    PersistentSolution grouping_crossover(const PersistentSolution& parent_a, const vector<Bin>& parent_b){
+        VNS_TRACE_SCOPE("grouping crossover");
+        VNS_ALLOC_PHASE("grouping crossover");
+        vector<const Bin*> parent_bins;
+        for (auto &bin: parent_a){
+            parent_bins.push_back(&bin);
+        }
+        for (auto &bin: parent_b){
+            parent_bins.push_back(&bin);
+        }
+        stable_sort(parent_bins.begin(), parent_bins.end(), [](const Bin* bin_a, const Bin* bin_b){
+            return bin_a->get_remaining_size() < bin_b->get_remaining_size();
+        });
+
+        long max_item_ID = 0;
+        for (auto &item: original_items){
+            max_item_ID = max(max_item_ID, item.get_item_ID());
+        }
+        vector<bool> is_inherited(max_item_ID + 1, false);
+        PersistentSolution child;
+        for (const Bin* bin: parent_bins){
+            bool clashes = false;
+            for (auto &item: bin->items_in_bin){
+                if (is_inherited[item.get_item_ID()]){
+                    clashes = true;
+                    break;
+                }
+            }
+            if (clashes) continue;
+            for (auto &item: bin->items_in_bin){
+                is_inherited[item.get_item_ID()] = true;
+            }
+            child.push_back(*bin);
+        }
+
+        vector<Item> items_left;
+        for (auto &item: original_items){
+            if (!is_inherited[item.get_item_ID()]) items_left.push_back(item);
+        }
+        repack_best_fit_decreasing(&child, items_left);
+        return child;
+    }
+
+
+    //pack the items into the bins of the solution with best fit, largest item first, new bins are opened when needed
+    void repack_best_fit_decreasing(PersistentSolution* packed_solution, vector<Item> items){
+        PersistentSolution &current_solution = *packed_solution;
+        sort(items.begin(), items.end(), [](const Item& item_a, const Item& item_b){
+            return item_a.get_item_size() > item_b.get_item_size();
+        });
+        vector<long> &residuals = residual_buffer;
+        residuals.clear();
+        for (auto &bin: current_solution){
+            residuals.push_back(bin.get_remaining_size());
+        }
+        for (auto &item: items){
+            long best_bin_index = find_best_bin(residuals, item.get_item_size());
+            if (best_bin_index != -1){ //if there is a suitable bin
+                current_solution.modify(best_bin_index).add_item_to_bin(item);
+                residuals[best_bin_index] = current_solution[best_bin_index].get_remaining_size();
+            }else{ //if there is no suitable bin, create a new bin for the item
+                Bin created_bin(bin_capacity);
+                if (!created_bin.add_item_to_bin(item)){
+                    report_message("error adding object");
+                }
+                current_solution.push_back(created_bin);
+                residuals.push_back(created_bin.get_remaining_size());
+            }
+        }
+    }
+
+
+
+    //Extract three items individually from bin ABC, and insert them back to BC if possible
+    PersistentSolution first_descent_vns_0(bool *is_better, const PersistentSolution& given_solution, search_clock::time_point time_start){
+        //1-1-1 swap
+
+        //note the time
+        search_clock::time_point time_fin, time_start_session;
+        double time_spent=0;
+        double time_spent_session= 0;
+        time_start_session = search_clock::now();
+        //sort the bin to have the most empty one in the front to easierly carry out the swap
+        PersistentSolution sorted_bins = sort_bin_according_to_remaining_size(given_solution);
+
+        //the remaining size and the smallest and largest item of each bin, the items in a bin are sorted from the smallest
+        long bin_nums = sorted_bins.size();
+        vector<long> slacks(bin_nums), min_items(bin_nums), max_items(bin_nums);
+        for (long bin_index = 0; bin_index < bin_nums; bin_index++){
+            const Bin& bin = sorted_bins[bin_index];
+            slacks[bin_index] = bin.get_remaining_size();
+            min_items[bin_index] = bin.is_empty() ? 0 : bin.items_in_bin.front().get_item_size();
+            max_items[bin_index] = bin.is_empty() ? 0 : bin.items_in_bin.back().get_item_size();
+        }
+
+        //go through the three bins
+        //the item of bin i moves into the room of bins j and k, and so needs slack j + slack k, since the slacks
+        //decrease along the sorted bins, once they are too small for the smallest item of bin i the later bins are too
+        vector<long> candidates(bin_nums); //the bins k for bins i and j, found by the scan kernel
+        for(int i = 0; i < bin_nums; i++){
+            if (slacks[i] == 0) break; //the full bins are at the end
+            for (int j = i+1; j < bin_nums; j++){
+                if (j + 1 >= bin_nums or slacks[j] + slacks[j+1] < min_items[i]) break;
+                //the time is checked for every pair, the scan for the bins k costs as much whether it finds some or not
+                time_fin=search_clock::now();
+                time_spent = seconds_between(time_start, time_fin);
+                time_spent_session = seconds_between(time_start_session, time_fin);
+                if (time_spent >= max_time or stop_requested() or time_spent_session > 5){ //check the time and return if time is up
+                    return given_solution;
+                }
+                long candidate_nums = residual_kernels().filter_between(slacks.data() + j + 1, bin_nums - j - 1,
+                                                                        max(1L, min_items[i] - slacks[j]), slacks[j], candidates.data());
+                for (long candidate = 0; candidate < candidate_nums; candidate++){
+                    long k = j + 1 + candidates[candidate];
+
+                    time_fin=search_clock::now();
+                    time_spent = seconds_between(time_start, time_fin);
+                    time_spent_session = seconds_between(time_start_session, time_fin);
+                    if (time_spent >= max_time or stop_requested() or time_spent_session > 5){ //check the time and return if time is up
+                        return given_solution;
+                    }
+
+                    //bins j and k swap an item each, the difference d of the item of j and the item of k must be
+                    //in (0, slack k] with the item of i going to j, or in [-slack j, 0] with it going to k,
+                    //and leave room for the smallest item of i
+                    long lowest_difference = min_items[j] - max_items[k];
+                    long highest_difference = max_items[j] - min_items[k];
+                    bool fits_into_j = max(1L, min_items[i] - slacks[j]) <= min(slacks[k], highest_difference)
+                                       and lowest_difference <= slacks[k];
+                    bool fits_into_k = max(-slacks[j], lowest_difference) <= min(-max(0L, min_items[i] - slacks[k]), highest_difference);
+                    if (!fits_into_j and !fits_into_k) continue;
+
+                    //get the three bin indexes to move, remaining space of i is >= j's and j's >=k's
+                    vector<long> moving_indexes;
+                    moving_indexes.push_back(i);
+                    moving_indexes.push_back(j);
+                    moving_indexes.push_back(k);
+                    bool move_successful = false;
+                    //try to move the elements across bins
+                    PersistentSolution current_solution = apply_move_across_bins(&move_successful, sorted_bins, moving_indexes);
+
+                    //if moved, check if the solution is better
+                    if (move_successful) {
+                        if (evaluate_solution(given_solution, current_solution)) {
+                            //first descent, if found directly return
+                            *is_better = true;
+                            return current_solution;
+
+                        }
+                    }
+                }
+            }
+        }
+        return given_solution;
+    }
+
+
+    //choose one bin to move items from, this function will move all items from the bin as possible to other bins
+    PersistentSolution first_descent_vns_1 (bool *is_better, const PersistentSolution& given_solution, search_clock::time_point time_start){
+        //move action 1-0
+        PersistentSolution best_solution = given_solution;
+        PersistentSolution current_solution = best_solution;
+
+        //note the start time
+        search_clock::time_point time_fin, time_start_session;
+        double time_spent=0;
+        double time_spent_session= 0;
+        time_start_session = search_clock::now();
+
+        //find a bin to move items from
+        for (int from_bin = 0; from_bin < given_solution.size(); from_bin++){
+            time_fin=search_clock::now();
+            time_spent = seconds_between(time_start, time_fin);
+            time_spent_session = seconds_between(time_start_session, time_fin);
+            if (time_spent >= max_time or stop_requested() or time_spent_session > 5){ //if the time is up, break the search
+                return given_solution;
+            }
+
+
+            bool move_successful = false;
+            //apply move from the bin
+            current_solution = apply_move(&move_successful, given_solution, from_bin);
+            if (move_successful) {
+                if (evaluate_solution(best_solution, current_solution)) {
+                    //first descent, if found directly return
+                    *is_better = true;
+                    return current_solution;
+                }
+            }
+
+        }
+        return best_solution;
+    }
+
+
+    //choose two bins to move items in between
+    PersistentSolution first_descent_vns_2 (bool *is_better, const PersistentSolution& given_solution, search_clock::time_point time_start){
+        //1-1 swap
+        return first_descent_swap<1, 1>(is_better, given_solution, time_start);
+    }
+
+    //choose two bins to move items in between, and one from bin A and two from bin B
+    PersistentSolution first_descent_vns_3 (bool *is_better, const PersistentSolution& given_solution, search_clock::time_point time_start){
+        //1-2 swap
+        return first_descent_swap<1, 2>(is_better, given_solution, time_start);
+    }
+
+    //choose two bins to move items in between, two items from bin A and two from bin B
+    PersistentSolution first_descent_vns_4 (bool *is_better, const PersistentSolution& given_solution, search_clock::time_point time_start){
+        //2-2 swap
+        return first_descent_swap<2, 2>(is_better, given_solution, time_start);
+    }
+
+
+    //choose two bins and swap K items from bin A with L items from bin B using the swap kernel of the K-L shape
+    template <int K, int L>
+    PersistentSolution first_descent_swap (bool *is_better, const PersistentSolution& given_solution, search_clock::time_point time_start){
+        //note the start time
+        search_clock::time_point time_fin, time_start_session;
+        double time_spent=0;
+        double time_spent_session= 0;
+        time_start_session = search_clock::now();
+
+        long old_sln_optimity = 0;
+        for (auto &bin: given_solution){
+            old_sln_optimity += bin.get_remaining_size() * bin.get_remaining_size();
+        }
+
+        array<long, K> positions_A;
+        array<long, L> positions_B;
+
+        //find two bins to move items from, a K-K swap is symmetric so each pair of bins is only tried once
+        for (long bin_A_index = 0; bin_A_index < given_solution.size(); bin_A_index++){
+            for (long bin_B_index = (K == L ? bin_A_index+1 : 0); bin_B_index < given_solution.size(); bin_B_index++) {
+                time_fin=search_clock::now();
+                time_spent = seconds_between(time_start, time_fin);
+                time_spent_session = seconds_between(time_start_session, time_fin);
+                if (time_spent >= max_time or stop_requested() or time_spent_session > 3){//if the time is up, break the search
+                    return given_solution;
+                }
+                if (bin_A_index == bin_B_index) continue;
+
+                const Bin& binA = given_solution.at(bin_A_index);
+                const Bin& binB = given_solution.at(bin_B_index);
+                SwapEvaluation evaluation = {old_sln_optimity, binA.get_remaining_size(), binB.get_remaining_size()};
+
+                if (swap_kernel<K, L>::search(binA, binB, evaluation, positions_A, positions_B)){
+                    //first descent, if found directly return
+                    *is_better = true;
+                    return apply_swap<K, L>(given_solution, bin_A_index, bin_B_index, positions_A, positions_B);
+                }
+            }
+        }
+        return given_solution;
+    }
+
+    //swap the items at the positions in bin A with the items at the positions in bin B
+    template <int K, int L>
+    PersistentSolution apply_swap(const PersistentSolution& given_bin, long bin_A_index, long bin_B_index,
+                                  const array<long, K>& positions_A, const array<long, L>& positions_B){
+        PersistentSolution new_bin = given_bin;
+        const Bin& binA = given_bin[bin_A_index]; //the bins of the given solution are not changed by the swap
+        const Bin& binB = given_bin[bin_B_index];
+
+        //remove items from the original bins
+        for (long position: positions_A){
+            new_bin.modify(bin_A_index).remove_item_from_bin(binA.items_in_bin[position].get_item_ID());
+        }
+        for (long position: positions_B){
+            new_bin.modify(bin_B_index).remove_item_from_bin(binB.items_in_bin[position].get_item_ID());
+        }
+
+        //add item to new bin (swap)
+        for (long position: positions_A){
+            if(!new_bin.modify(bin_B_index).add_item_to_bin(binA.items_in_bin[position])){
+                report_message("error adding object");
+            }
+        }
+        for (long position: positions_B){
+            if(!new_bin.modify(bin_A_index).add_item_to_bin(binB.items_in_bin[position])){
+                report_message("error adding object");
+            }
+        }
+
+        if (new_bin.at(bin_A_index).is_empty()){ //if all items of bin A are moved, delete the bin
+            new_bin.erase(bin_A_index);
+        }
+        return new_bin;
+    }
+
+
+
+
+    PersistentSolution first_descent_vns_5 (bool *is_better, const PersistentSolution& given_solution, search_clock::time_point time_start){
+        //1-n swap, to find optimal solution
+        PersistentSolution current_solution = sort_bin_according_to_remaining_size(given_solution);
+
+
+        //note the start time
+        search_clock::time_point time_fin, time_start_session;
+        double time_spent=0;
+        double time_spent_session= 0;
+        time_start_session = search_clock::now();
+
+        //calculate the full bin start index to reduce analysis time
+        long full_bin_starts_at = 0;
+        for (long from_bin_index = 0; from_bin_index < current_solution.size(); from_bin_index++){
+            if (current_solution[from_bin_index].get_remaining_size() == 0) {
+                full_bin_starts_at = from_bin_index;
+                break;
+            }
+        }
+
+
+        //select one bin
+        for (long from_bin_index = 0 ; from_bin_index < full_bin_starts_at; from_bin_index++){
+            //select the bin from which n items to be swapped
+            for(long multiple_items_bin_index = current_solution.size()-1; multiple_items_bin_index >=0; multiple_items_bin_index--){
+                time_fin=search_clock::now();
+                time_spent = seconds_between(time_start, time_fin);
+                time_spent_session = seconds_between(time_start_session, time_fin);
+                if (time_spent >= max_time or stop_requested() or time_spent_session > 3){//if the time is up, break the search
+                    return given_solution;
+                }
+
+                //if all bins are searched, no bettter result
+                if (from_bin_index == multiple_items_bin_index) {
+                    *is_better = false;
+                    return given_solution;
+                }
+                bool move_successful = false;
+                //move one item in bin A with items in bin B
+                current_solution = apply_move(&move_successful, current_solution, from_bin_index, multiple_items_bin_index);
+                if (move_successful){
+                    *is_better = true;
+                    return current_solution;
+                }
+            }
+        }
+        *is_better = false;
+        return given_solution;
+    }
+
+
+
+
+
+
+
+
+
+
+
+    //this function sorts the bin according to the remaining size, in descending order. The first is the most available bin
+    PersistentSolution sort_bin_according_to_remaining_size(const PersistentSolution& given_bins){
+        PersistentSolution new_bin = given_bins; //the sorted snapshot shares the bins with the given one
+        new_bin.sort_by_remaining_size();
+        return new_bin;
+    }
+
+    //sort the items in descending order
+    vector<Item> sort_items_descending(vector<Item> original_items){
+        VNS_TRACE_SCOPE("sort items");
+        vector<Item> sorted_items_descending;
+        bool item_added = false;
+        for (int item_index = 0; item_index < original_items.size(); item_index++){// go through every item in the list
+            item_added = false;
+            Item item_inserted =original_items[item_index];
+            long item_size_at_index = item_inserted.get_item_size();
+
+            long sorted_items_index = 0;
+            long sorted_items_vector_size = sorted_items_descending.size();
+            while(sorted_items_index < sorted_items_vector_size and !item_added){ //compare the current item with items in the new list
+                long sorted_item_size_at_index = sorted_items_descending.at(sorted_items_index).get_item_size();
+                //if the current item is larger than the item of index in the new list, insert the item at index in the new list
+                if (item_size_at_index > sorted_item_size_at_index){
+                    sorted_items_descending.insert(sorted_items_descending.begin()+sorted_items_index, item_inserted);
+                    item_added = true;
+                }
+                sorted_items_index++;
+            }
+            //if the item is not larger than any in the new list, append it to the end of new list
+            if (!item_added){
+                sorted_items_descending.push_back(item_inserted);
+                item_added = true;
+            }
+        }
+        return sorted_items_descending;
+    }
+
+
+    //this function moves items in the case 1-1-1, which moves item from bin0 to bin1 or bin2, and swap bin1 and bin2
+    //the solution is only copied once a move is found, an empty solution is returned otherwise
+    PersistentSolution apply_move_across_bins(bool* move_successful,  const PersistentSolution& given_bin, vector<long> indexes_to_be_moved){
+        PersistentSolution current_sln;
+
+        //move from bin0 to other two bins, because bin0's remaining size >= bin1 and bin2
+        const Bin& bin_0 = given_bin[indexes_to_be_moved[0]];
+        const Bin& bin_1 = given_bin[indexes_to_be_moved[1]];
+        const Bin& bin_2 = given_bin[indexes_to_be_moved[2]];
+
+        long bin_0_rem_size = bin_0.get_remaining_size();
+        long bin_1_rem_size = bin_1.get_remaining_size();
+        long bin_2_rem_size = bin_2.get_remaining_size();
+
+        //go through every item in bin0 bin1 and bin2, to check if they can be swapped and insert the bin0 item
+        //to bin1 or bin2
+        for(auto item_in_b0: bin_0.items_in_bin){
+            //if the item in bin0 is too large, skip the swap
+            if (item_in_b0.get_item_size() > bin_1_rem_size + bin_2_rem_size) continue;
+            long item_b0_size = item_in_b0.get_item_size();
+            for (auto item_in_b1: bin_1.items_in_bin){
+                long item_b1_size = item_in_b1.get_item_size();
+                for (auto item_in_b2: bin_2.items_in_bin){
+                    long item_b2_size = item_in_b2.get_item_size();
+
+                    if (item_b1_size > item_b2_size){
+                        if (item_b1_size <= bin_2_rem_size + item_b2_size) {
+                            if (item_b0_size + item_b2_size <= bin_1_rem_size + item_b1_size) {
+                                // 0->1 2->1 1->2 case
+                                current_sln = given_bin;
+                                //remove three items from the bin
+                                current_sln.modify(indexes_to_be_moved[0]).remove_item_from_bin(item_in_b0.get_item_ID());
+                                current_sln.modify(indexes_to_be_moved[1]).remove_item_from_bin(item_in_b1.get_item_ID());
+                                current_sln.modify(indexes_to_be_moved[2]).remove_item_from_bin(item_in_b2.get_item_ID());
+
+                                //insert three items into the bin, item0 to bin1, item2 to bin1, item1 to bin2
+                                current_sln.modify(indexes_to_be_moved[1]).add_item_to_bin(item_in_b0);
+                                current_sln.modify(indexes_to_be_moved[1]).add_item_to_bin(item_in_b2);
+                                current_sln.modify(indexes_to_be_moved[2]).add_item_to_bin(item_in_b1);
+
+                                //if bin0 is now empty, remove it from the solution list
+                                if(current_sln.at(indexes_to_be_moved[0]).is_empty()){
+                                    current_sln.erase(indexes_to_be_moved[0]);
+                                }
+                                *move_successful = true;
+                                return current_sln;
+                            }
+                        }
+                    }else{
+                        if (item_b2_size <= bin_1_rem_size + item_b1_size) {
+                            if (item_b0_size + item_b1_size <= bin_2_rem_size + item_b2_size){
+                                // 0->2 2->1 1->2 case
+                                current_sln = given_bin;
+                                //remove three items from the bin
+                                current_sln.modify(indexes_to_be_moved[0]).remove_item_from_bin(item_in_b0.get_item_ID());
+                                current_sln.modify(indexes_to_be_moved[1]).remove_item_from_bin(item_in_b1.get_item_ID());
+                                current_sln.modify(indexes_to_be_moved[2]).remove_item_from_bin(item_in_b2.get_item_ID());
+
+                                //insert three items into the bin, item0 to bin2, item2 to bin1, item1 to bin2
+                                current_sln.modify(indexes_to_be_moved[2]).add_item_to_bin(item_in_b0);
+                                current_sln.modify(indexes_to_be_moved[1]).add_item_to_bin(item_in_b2);
+                                current_sln.modify(indexes_to_be_moved[2]).add_item_to_bin(item_in_b1);
+
+                                //if bin0 is now empty, remove it from the solution list
+                                if(current_sln.at(indexes_to_be_moved[0]).is_empty()){
+                                    current_sln.erase(indexes_to_be_moved[0]);
+                                }
+                                *move_successful = true;
+                                return current_sln;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        *move_successful = false;
+        return current_sln;
+    }
+
+    //this function applies move from one bin to other bins, it will try move all the items in the bin to others
+    PersistentSolution apply_move(bool* move_successful,  const PersistentSolution& given_bin, long from_bin_index){
+        PersistentSolution new_bin = given_bin;
+        long given_bin_size = new_bin[from_bin_index].get_item_nums();
+        long at_nth_in_bin = 0;
+        bool obj_moved = false;
+
+        //the remaining size of each bin for the scan kernels, the bin moved from never takes an item
+        vector<long> &residuals = residual_buffer;
+        residuals.clear();
+        for (auto &bin: new_bin){
+            residuals.push_back(bin.get_remaining_size());
+        }
+        residuals[from_bin_index] = -1;
+
+        //go through every item in the bin
+        while(at_nth_in_bin < given_bin_size){
+            long item_size = new_bin[from_bin_index].items_in_bin[at_nth_in_bin].get_item_size();
+            Item item_to_be_moved = new_bin[from_bin_index].items_in_bin[at_nth_in_bin];
+
+            //the first bin with room for the item
+            long new_bin_index = residual_kernels().first_at_least(residuals.data(), residuals.size(), item_size);
+            if (new_bin_index != -1){
+                //if can transfer the item
+                if(!new_bin.modify(from_bin_index).remove_nth_item_from_bin(at_nth_in_bin)){ //remove from original bin
+                    report_message("error removing object");
+                };
+
+                if(!new_bin.modify(new_bin_index).add_item_to_bin(item_to_be_moved)){ //add to the new bin
+                    report_message("error adding object");
+                }
+                residuals[new_bin_index] = new_bin[new_bin_index].get_remaining_size();
+                obj_moved = true;
+            }
+            if (obj_moved){//if the object is moved, reset the search
+                at_nth_in_bin = 0;
+                given_bin_size = new_bin[from_bin_index].get_item_nums();
+                obj_moved = false;
+            }
+            else{
+                at_nth_in_bin++; //keep searching
+            }
+        }
+
+
+        if(new_bin.at(from_bin_index).is_empty()){ //if the bin from which items are moved is empty, delete the bin
+            new_bin.erase(from_bin_index);
+        }
+        *move_successful = true;
+        return new_bin;
+    }
+
+    // this function can swap multiple objects between two bins
+    PersistentSolution apply_move(bool* move_successful,  const PersistentSolution& given_bin, vector<long> indexes_to_be_moved_A, vector<long> indexes_to_be_moved_B){
+        //if given data is not enough for a move, abandon the move
+        if (given_bin.size() == 0 or indexes_to_be_moved_A.size() == 0 or indexes_to_be_moved_B.size() == 0) {
+            *move_successful = false;
+            return given_bin;
+        }
+
+        long first_index_in_A = indexes_to_be_moved_A.at(0);
+        long first_index_in_B = indexes_to_be_moved_B.at(0);
+        long bin_id_moved_from_A = -1;
+        long bin_id_moved_from_B = -1;
+
+        //get the index of bins
+        for(long i =0; i < given_bin.size(); i++){
+            if (given_bin.at(i).is_item_exists(first_index_in_A)) bin_id_moved_from_A = i;
+            if (given_bin.at(i).is_item_exists(first_index_in_B)) bin_id_moved_from_B = i;
+        }
+
+        //if the index of bins cannot be found
+        if (bin_id_moved_from_A == -1 or bin_id_moved_from_B == -1){
+            *move_successful = false;
+            return given_bin;
+        }
+
+        //if bin A/B does not contain all the items from indexes_to_be_moved_A/B, stop moving
+        for (auto index_to_be_moved_A: indexes_to_be_moved_A){
+            if (!given_bin.at(bin_id_moved_from_A).is_item_exists(index_to_be_moved_A)) {
+                *move_successful = false;
+                return given_bin;
+            }
+        }
+        for (auto index_to_be_moved_B: indexes_to_be_moved_B){
+            if (!given_bin.at(bin_id_moved_from_B).is_item_exists(index_to_be_moved_B)) {
+                *move_successful = false;
+                return given_bin;
+            }
+        }
+
+        //calculate the remaining bin size and item size
+        long bin_A_remaining_size = given_bin.at(bin_id_moved_from_A).get_remaining_size();
+        long bin_B_remaining_size = given_bin.at(bin_id_moved_from_B).get_remaining_size();
+
+        long items_A_size = 0;
+        long items_B_size = 0;
+        for (auto index_to_be_moved_A: indexes_to_be_moved_A){
+            items_A_size+= given_bin.at(bin_id_moved_from_A).get_item_size(index_to_be_moved_A);
+        }
+        for (auto index_to_be_moved_B: indexes_to_be_moved_B){
+            items_B_size+= given_bin.at(bin_id_moved_from_B).get_item_size(index_to_be_moved_B);
+        }
+
+
+
+        //if not enough space for move, stop moving
+        if ((bin_A_remaining_size + items_A_size - items_B_size < 0) or
+            (bin_B_remaining_size + items_B_size - items_A_size < 0)){
+            *move_successful = false;
+            return given_bin;
+        }
+
+
+        //if enough space for moving, start moving
+        PersistentSolution new_bin = given_bin;
+        vector<Item> items_A;
+        vector<Item> items_B;
+
+        //remove item from original bin
+        for (auto index_to_be_moved_A: indexes_to_be_moved_A) {
+            items_A.push_back(new_bin.at(bin_id_moved_from_A).get_item(index_to_be_moved_A));
+            if (!new_bin.modify(bin_id_moved_from_A).remove_item_from_bin(index_to_be_moved_A)){
+                report_message("error deleting object");
+            };
+        }
+
+        for (auto index_to_be_moved_B: indexes_to_be_moved_B) {
+            items_B.push_back(new_bin.at(bin_id_moved_from_B).get_item(index_to_be_moved_B));
+            if (!new_bin.modify(bin_id_moved_from_B).remove_item_from_bin(index_to_be_moved_B)){
+                report_message("error deleting object");
+            };
+        }
+
+
+        //add item to new bin (swap)
+        for(auto item_A: items_A){
+            if(!new_bin.modify(bin_id_moved_from_B).add_item_to_bin(item_A)){
+                report_message("error adding object");
+            };
+        }
+        for(auto item_B: items_B){
+            if(!new_bin.modify(bin_id_moved_from_A).add_item_to_bin(item_B)){
+                report_message("error adding object");
+            };
+        }
+        *move_successful = true;
+        return new_bin;
+    }
+
+
+
+    //this function swaps one item of bin1 with a subset of the items in bin2 (1-n swap)
+    //the subset is found by an exact subset-sum search over bin2, choosing the smallest subset size which still lets
+    //bin2 take the item, so bin2 is filled as much as possible while both bins stay within the capacity
+    PersistentSolution apply_move(bool* move_successful,  const PersistentSolution& given_bin, long bin1_index, long bin2_index){
+        const Bin& bin_1 = given_bin[bin1_index];
+        const Bin& bin_2 = given_bin[bin2_index];
+        if (bin_1.is_empty() or bin_2.is_empty()){
+            *move_successful = false;
+            return given_bin;
+        }
+
+        //the subsets given back are smaller than the item, so the sums are only needed below the largest item of bin1
+        //the table would be too large for very large items, and then the greedy move picks the subset instead
+        long largest_item_size = bin_1.items_in_bin.back().get_item_size();
+        if (largest_item_size > subset_sum_max_size){
+            return apply_greedy_one_to_n_move(move_successful, given_bin, bin1_index, bin2_index);
+        }
+        if (!build_subset_sum_table(bin_2, largest_item_size - 1)){
+            *move_successful = false;
+            return given_bin;
+        }
+
+        //select one element in the non full bin, from the largest
+        for(long from_nth_element_in_bin = bin_1.get_item_nums()-1; from_nth_element_in_bin >= 0; from_nth_element_in_bin--){
+            Item itemA = bin_1.items_in_bin[from_nth_element_in_bin];
+            long item_size = itemA.get_item_size();
+
+            //bin2 must have room for item A after giving the subset back, and the subset must be smaller than item A
+            //so that the move is better, which also keeps bin1 within the capacity
+            long subset_size = find_smallest_subset_sum(max(1L, item_size - bin_2.get_remaining_size()), item_size - 1);
+            if (subset_size == -1) continue; //no subset could be swapped with this item, search the next one
+
+            vector<Item> itemB = extract_subset(bin_2, subset_size);
+
+            //if the swap is feasible, do the swap
+            //remove items from the bins
+            PersistentSolution current_solution = given_bin;
+            current_solution.modify(bin1_index).remove_item_from_bin(itemA.get_item_ID());
+            for (auto item: itemB){
+                current_solution.modify(bin2_index).remove_item_from_bin(item.get_item_ID());
+            }
+
+            //add items (swap) items to the bins
+            current_solution.modify(bin2_index).add_item_to_bin(itemA);
+            for (auto item: itemB){
+                current_solution.modify(bin1_index).add_item_to_bin(item);
+            }
+            //return the swapped solution
+            *move_successful = true;
+            return current_solution;
+        }
+        *move_successful = false;
+        return given_bin;
+    }
+
+    //the 1-n swap of the items too large for the subset-sum table: the items of bin2 are taken in order until they
+    //make room for the item of bin1, and the swap is made if they are smaller than it and both bins stay in capacity
+    PersistentSolution apply_greedy_one_to_n_move(bool* move_successful,  const PersistentSolution& given_bin, long bin1_index, long bin2_index){
+        PersistentSolution current_solution = given_bin;
+
+        long current_bin_item_nums = current_solution[bin1_index].get_item_nums();
+        //select one element in the non full bin
+        for(long from_nth_element_in_bin = current_bin_item_nums-1; from_nth_element_in_bin >= 0; from_nth_element_in_bin--){
+            Item itemA = current_solution[bin1_index].items_in_bin[from_nth_element_in_bin];
+            long itemSize = itemA.get_item_size();
+
+            long sizeCounter = 0;
+            long swapTopNElement = 0;
+            vector<Item> itemB;
+
+            //select items from the second bin, and check the size of them and the remaining size
+            for (auto &itemInMultiBin: current_solution[bin2_index].items_in_bin){
+                sizeCounter += itemInMultiBin.get_item_size();
+                swapTopNElement++;
+                itemB.push_back(itemInMultiBin);
+                if (sizeCounter + current_solution[bin2_index].get_remaining_size() >= itemSize) break;
+            }
+
+            //if the swap is not better, search the next solution
+            if (sizeCounter >  itemSize  or swapTopNElement <=1){
+                continue;
+            }
+
+            //if no enough space to swap, search the next solution
+            if (current_solution[bin1_index].get_remaining_size() - sizeCounter + itemSize < 0 or
+                current_solution[bin2_index].get_remaining_size() + sizeCounter - itemSize < 0){
+                continue;
+            }
+
+            //if the swap is feasible, do the swap
+            current_solution.modify(bin1_index).remove_item_from_bin(itemA.get_item_ID());
+            for (auto &item: itemB){
+                current_solution.modify(bin2_index).remove_item_from_bin(item.get_item_ID());
+            }
+            current_solution.modify(bin2_index).add_item_to_bin(itemA);
+            for (auto &item: itemB){
+                current_solution.modify(bin1_index).add_item_to_bin(item);
+            }
+            *move_successful = true;
+            return current_solution;
+        }
+        *move_successful = false;
+        return given_bin;
+    }
+
+    //build the subset-sum table of the items in the bin as bitsets of the reachable sums up to max_sum
+    //row k of the table holds the sums reachable by the first k items of the bin
+    bool build_subset_sum_table(const Bin& bin, long max_sum){
+        if (max_sum < 1) return false;
+        subset_sum_words = max_sum/64 + 1;
+        subset_sum_rows = bin.get_item_nums() + 1;
+        long rows = subset_sum_rows;
+        if (subset_sum_table.size() < rows*subset_sum_words){ //grown, never shrunk, so the table is reused
+            subset_sum_table.resize(rows*subset_sum_words);
+        }
+        //every row after the first is written in full from the one before, so only the first is cleared
+        fill(subset_sum_table.begin(), subset_sum_table.begin() + subset_sum_words, 0);
+        subset_sum_table[0] = 1; //only the empty subset, sum 0
+
+        for (long k = 1; k < rows; k++){
+            const uint64_t* previous_row = &subset_sum_table[(k-1)*subset_sum_words];
+            uint64_t* row = &subset_sum_table[k*subset_sum_words];
+            long item_size = bin.items_in_bin[k-1].get_item_size();
+
+            //the sums without the item
+            for (long w = 0; w < subset_sum_words; w++) row[w] = previous_row[w];
+            if (item_size > max_sum) continue;
+
+            //the sums with the item, shift the previous row by the item size
+            long word_shift = item_size/64;
+            long bit_shift = item_size%64;
+            for (long w = subset_sum_words-1; w >= word_shift; w--){
+                uint64_t shifted = previous_row[w-word_shift] << bit_shift;
+                if (bit_shift != 0 and w-word_shift > 0){
+                    shifted |= previous_row[w-word_shift-1] >> (64-bit_shift);
+                }
+                row[w] |= shifted;
+            }
+        }
+        return true;
+    }
+
+    //find the smallest sum in [min_sum, max_sum] reachable by the items of the bin, -1 if no sum is reachable
+    long find_smallest_subset_sum(long min_sum, long max_sum){
+        if (min_sum > max_sum) return -1;
+        const uint64_t* row = &subset_sum_table[(subset_sum_rows-1)*subset_sum_words];
+        for (long sum = min_sum; sum <= max_sum; sum++){
+            uint64_t word = row[sum/64] >> (sum%64);
+            if (word == 0){ //skip the remaining of the word
+                sum = (sum/64)*64 + 63;
+                continue;
+            }
+            sum += __builtin_ctzll(word);
+            return sum <= max_sum ? sum : -1;
+        }
+        return -1;
+    }
+
+    //walk back the subset-sum table to get the items of the bin adding up to the sum
+    vector<Item> extract_subset(const Bin& bin, long sum){
+        vector<Item> subset;
+        for (long k = bin.get_item_nums(); k > 0 and sum > 0; k--){
+            const uint64_t* previous_row = &subset_sum_table[(k-1)*subset_sum_words];
+            if ((previous_row[sum/64] >> (sum%64)) & 1) continue; //the sum is reachable without the item
+            subset.push_back(bin.items_in_bin[k-1]);
+            sum -= bin.items_in_bin[k-1].get_item_size();
+        }
+        return subset;
+    }
+
+
+
+
+
+
+    //check which solution is better according to the sum of sqaure of the bin's remaining size
+    //works on both plain bins and solution snapshots
+    template <class Bins>
+    bool evaluate_solution(const Bins& old_solution, const Bins& new_solution){
+
+        //if the new solution contains less bins, it is no doubt better
+        if (new_solution.size() < old_solution.size()){
+            return true;
+        }
+        if (old_solution.size() < new_solution.size()){
+            return false;
+        }
+        long old_sln_optimity = 0;
+        long new_sln_optimity = 0;
+
+        long avg_old_sln_counter = 0;
+        long avg_old_sln_empty = 0;
+
+        //get the sum of square of the bin's remaining size
+        for (auto &old_sln_bin: old_solution){
+            old_sln_optimity += (old_sln_bin.get_remaining_size()) * (old_sln_bin.get_remaining_size());
+
+        }
+
+        for (auto &new_sln_bin: new_solution){
+            new_sln_optimity += (new_sln_bin.get_remaining_size()) * (new_sln_bin.get_remaining_size());
+        }
+
+        //if the new solution is better than the old one at some extent, it is better
+        return is_better_optimity(old_sln_optimity, new_sln_optimity);
+    }
+
+    //check if the solution is correct
+    template <class Bins>
+    bool check_solution_correctness(const Bins& solution, const vector<Item>& items){
+        VNS_TRACE_SCOPE("check solution");
+        vector<Item> slnitemlist;
+        //add the items from bins to a single list
+        for (auto &bin: solution){
+            for (auto &item: bin.items_in_bin){
+                slnitemlist.push_back(item);
+            }
+        }
+
+        //if the number of items contained in the solution is not the same as the original one, the solution is incorrect
+        if (slnitemlist.size() != items.size()){
+            report_message("Error!");
+            return false;
+        }
+
+        //if the items in the solution have duplicated ones, the solution is incorrect
+        for (long index = 0; index < slnitemlist.size(); index++) {
+            for (long index2 = 0; index2 < slnitemlist.size(); index2++) {
+                if (slnitemlist[index].get_item_ID() == slnitemlist[index2].get_item_ID() and index!=index2){
+                    report_message("Error!");
+                    return false;
+                }
+            }
+        }
+
+        //calculate the match of items between the solution and the original ones.
+        long standard_num_items = items.size();
+        for (auto item1: slnitemlist){
+            for (auto item2: items){
+                if (item1.get_item_ID() == item2.get_item_ID() and item1.get_item_size() == item2.get_item_size()){
+                    standard_num_items--;
+                }
+            }
+        }
+
+        //if the match of items are not the number of items, it is incorrect
+        if (standard_num_items != 0) {
+            report_message("Error!");
+            return false;
+        }
+
+        //otherwise, the solution is correct
+        //        cout<<"correct!"<<endl;
+        return true;
+    }
+};
+
+} // namespace vns_bpp
+
+#endif //VNS_SOLUTION_H